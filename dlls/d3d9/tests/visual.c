@@ -27542,11 +27542,173 @@ static void test_filling_convention(void)
     DestroyWindow(window);
 }
 
+static void test_shader_cache_child(void)
+{
+    IDirect3DVertexShader9 *vs;
+    IDirect3DPixelShader9 *ps;
+    IDirect3DDevice9 *device;
+    IDirect3D9 *d3d;
+    ULONG refcount;
+    D3DCAPS9 caps;
+    DWORD color;
+    HWND window;
+    HRESULT hr;
+
+    static const DWORD vs_code[] =
+    {
+        0xfffe0200,                                                             /* vs_2_0                     */
+        0x0200001f, 0x80000000, 0x900f0000,                                     /* dcl_position v0            */
+        0x02000001, 0xc00f0000, 0x90e40000,                                     /* mov oPos, v0               */
+        0x0000ffff                                                              /* end                        */
+    };
+    static const DWORD ps_code[] =
+    {
+        0xffff0200,                                                             /* ps_2_0                     */
+        0x05000051, 0xa00f0000, 0x00000000, 0x00000000, 0x3f800000, 0x3f800000, /* def c0, 0.0, 0.0, 1.0, 1.0 */
+        0x02000001, 0x800f0800, 0xa0e40000,                                     /* mov oC0, c0                */
+        0x0000ffff                                                              /* end                        */
+    };
+    static const struct vec3 quad[] =
+    {
+        {-1.0f, -1.0f, 0.1f},
+        {-1.0f,  1.0f, 0.1f},
+        { 1.0f, -1.0f, 0.1f},
+        { 1.0f,  1.0f, 0.1f},
+    };
+
+    window = create_window();
+    d3d = Direct3DCreate9(D3D_SDK_VERSION);
+    ok(!!d3d, "Failed to create a D3D object.\n");
+    if (!(device = create_device(d3d, window, window, TRUE)))
+    {
+        skip("Failed to create a D3D device, skipping tests.\n");
+        goto done;
+    }
+
+    hr = IDirect3DDevice9_GetDeviceCaps(device, &caps);
+    ok(SUCCEEDED(hr), "Failed to get device caps, hr %#x.\n", hr);
+    if (caps.VertexShaderVersion < D3DVS_VERSION(2, 0) || caps.PixelShaderVersion < D3DPS_VERSION(2, 0))
+    {
+        skip("No shader model 2 support, skipping tests.\n");
+        IDirect3DDevice9_Release(device);
+        goto done;
+    }
+
+    hr = IDirect3DDevice9_CreateVertexShader(device, vs_code, &vs);
+    ok(SUCCEEDED(hr), "Failed to create vertex shader, hr %#x.\n", hr);
+    hr = IDirect3DDevice9_CreatePixelShader(device, ps_code, &ps);
+    ok(SUCCEEDED(hr), "Failed to create pixel shader, hr %#x.\n", hr);
+    hr = IDirect3DDevice9_SetVertexShader(device, vs);
+    ok(SUCCEEDED(hr), "Failed to set vertex shader, hr %#x.\n", hr);
+    hr = IDirect3DDevice9_SetPixelShader(device, ps);
+    ok(SUCCEEDED(hr), "Failed to set pixel shader, hr %#x.\n", hr);
+    hr = IDirect3DDevice9_SetFVF(device, D3DFVF_XYZ);
+    ok(SUCCEEDED(hr), "Failed to set FVF, hr %#x.\n", hr);
+    hr = IDirect3DDevice9_SetRenderState(device, D3DRS_ZENABLE, D3DZB_FALSE);
+    ok(SUCCEEDED(hr), "Failed to disable depth test, hr %#x.\n", hr);
+
+    hr = IDirect3DDevice9_Clear(device, 0, NULL, D3DCLEAR_TARGET, 0xffff0000, 1.0f, 0);
+    ok(SUCCEEDED(hr), "Failed to clear, hr %#x.\n", hr);
+    hr = IDirect3DDevice9_BeginScene(device);
+    ok(SUCCEEDED(hr), "Failed to begin scene, hr %#x.\n", hr);
+    hr = IDirect3DDevice9_DrawPrimitiveUP(device, D3DPT_TRIANGLESTRIP, 2, quad, sizeof(*quad));
+    ok(SUCCEEDED(hr), "Failed to draw, hr %#x.\n", hr);
+    hr = IDirect3DDevice9_EndScene(device);
+    ok(SUCCEEDED(hr), "Failed to end scene, hr %#x.\n", hr);
+    color = getPixelColor(device, 320, 240);
+    ok(color_match(color, 0x000000ff, 1), "Got unexpected color 0x%08x.\n", color);
+
+    IDirect3DVertexShader9_Release(vs);
+    IDirect3DPixelShader9_Release(ps);
+    refcount = IDirect3DDevice9_Release(device);
+    ok(!refcount, "Device has %u references left.\n", refcount);
+done:
+    IDirect3D9_Release(d3d);
+    DestroyWindow(window);
+}
+
+/* "ShaderCachePath" is a Wine setting, read when wined3d is loaded, so the
+ * draws are done in child processes. The second one is expected to load the
+ * program linked by the first one from the cache. */
+static void test_shader_cache(void)
+{
+    char exe[MAX_PATH], path[MAX_PATH], file[MAX_PATH], key_name[MAX_PATH + 64], cmdline[MAX_PATH * 2];
+    unsigned int i, count = 0;
+    PROCESS_INFORMATION pi;
+    STARTUPINFOA si = {0};
+    WIN32_FIND_DATAA data;
+    HANDLE find;
+    LONG error;
+    char *name;
+    HKEY key;
+    BOOL ret;
+
+    GetModuleFileNameA(NULL, exe, ARRAY_SIZE(exe));
+    name = (name = strrchr(exe, '\\')) ? name + 1 : exe;
+    sprintf(key_name, "Software\\Wine\\AppDefaults\\%s\\Direct3D", name);
+
+    GetTempPathA(ARRAY_SIZE(path), path);
+    strcat(path, "d3d9_shader_cache");
+    ret = CreateDirectoryA(path, NULL);
+    ok(ret || GetLastError() == ERROR_ALREADY_EXISTS, "Failed to create directory %s, error %u.\n", debugstr_a(path), GetLastError());
+
+    error = RegCreateKeyExA(HKEY_CURRENT_USER, key_name, 0, NULL, 0, KEY_SET_VALUE, NULL, &key, NULL);
+    ok(!error, "Failed to create key, error %d.\n", error);
+    error = RegSetValueExA(key, "ShaderCachePath", 0, REG_SZ, (const BYTE *)path, strlen(path) + 1);
+    ok(!error, "Failed to set value, error %d.\n", error);
+
+    sprintf(cmdline, "\"%s\" visual shader_cache", exe);
+    si.cb = sizeof(si);
+    for (i = 0; i < 2; ++i)
+    {
+        ret = CreateProcessA(NULL, cmdline, NULL, NULL, FALSE, 0, NULL, NULL, &si, &pi);
+        ok(ret, "Failed to create process, error %u.\n", GetLastError());
+        if (!ret)
+            break;
+        wait_child_process(pi.hProcess);
+        CloseHandle(pi.hProcess);
+        CloseHandle(pi.hThread);
+    }
+
+    RegDeleteValueA(key, "ShaderCachePath");
+    RegCloseKey(key);
+    RegDeleteKeyA(HKEY_CURRENT_USER, key_name);
+    *strrchr(key_name, '\\') = 0;
+    RegDeleteKeyA(HKEY_CURRENT_USER, key_name);
+
+    sprintf(file, "%s\\*", path);
+    if ((find = FindFirstFileA(file, &data)) != INVALID_HANDLE_VALUE)
+    {
+        do
+        {
+            if (data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY)
+                continue;
+            sprintf(file, "%s\\%s", path, data.cFileName);
+            ret = DeleteFileA(file);
+            ok(ret, "Failed to delete %s, error %u.\n", debugstr_a(file), GetLastError());
+            ++count;
+        } while (FindNextFileA(find, &data));
+        FindClose(find);
+    }
+    ret = RemoveDirectoryA(path);
+    ok(ret, "Failed to remove directory %s, error %u.\n", debugstr_a(path), GetLastError());
+    /* Nothing is cached on Windows, nor with drivers lacking
+     * ARB_get_program_binary. */
+    trace("Found %u programs in the shader cache.\n", count);
+}
+
 START_TEST(visual)
 {
     D3DADAPTER_IDENTIFIER9 identifier;
     IDirect3D9 *d3d;
     HRESULT hr;
+    char **argv;
+
+    if (winetest_get_mainargs(&argv) >= 3 && !strcmp(argv[2], "shader_cache"))
+    {
+        test_shader_cache_child();
+        return;
+    }
 
     if (!(d3d = Direct3DCreate9(D3D_SDK_VERSION)))
     {
@@ -27692,4 +27854,5 @@ START_TEST(visual)
     test_sample_mask();
     test_dynamic_map_synchronization();
     test_filling_convention();
+    test_shader_cache();
 }
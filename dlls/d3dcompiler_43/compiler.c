@@ -23,6 +23,7 @@
 #include "wine/debug.h"
 
 #include "d3dcompiler_private.h"
+#include "winreg.h"
 #include "wpp_private.h"
 
 WINE_DEFAULT_DEBUG_CHANNEL(d3dcompiler);
@@ -69,6 +70,26 @@ struct define
 
 static struct define *cmdline_defines;
 
+/* Bytecode of recently assembled shaders, keyed by the preprocessed source.
+ * Since that already contains the contents of included files and the
+ * expanded defines, repeated assembly of the same shader only needs to go
+ * through the preprocessor. It's enabled by setting the "AssemblyCache"
+ * registry value to "enabled". Protected by wpp_mutex. */
+#define ASSEMBLY_CACHE_SIZE 64
+
+struct assembly_cache_entry
+{
+    struct list entry;
+    unsigned int hash;
+    char *source;
+    DWORD *bytecode;
+    DWORD size;
+};
+
+static struct list assembly_cache = LIST_INIT(assembly_cache);
+static unsigned int assembly_cache_count;
+static BOOL assembly_cache_enabled;
+
 /* Mutex used to guarantee a single invocation
    of the D3DXAssembleShader function (or its variants) at a time.
    This is needed as wpp isn't thread-safe */
@@ -633,6 +654,94 @@ cleanup:
     return hr;
 }
 
+static unsigned int assembly_cache_hash(const char *source)
+{
+    unsigned int hash = 2166136261u;
+
+    while (*source)
+        hash = (hash ^ (unsigned char)*source++) * 16777619u;
+    return hash;
+}
+
+static struct assembly_cache_entry *assembly_cache_find(const char *source, unsigned int hash)
+{
+    struct assembly_cache_entry *entry;
+
+    LIST_FOR_EACH_ENTRY(entry, &assembly_cache, struct assembly_cache_entry, entry)
+    {
+        if (entry->hash == hash && !strcmp(entry->source, source))
+        {
+            /* Keep the most recently used entries at the front. */
+            list_remove(&entry->entry);
+            list_add_head(&assembly_cache, &entry->entry);
+            return entry;
+        }
+    }
+    return NULL;
+}
+
+static void assembly_cache_init(void)
+{
+    char buffer[16];
+    DWORD size = sizeof(buffer), type;
+    HKEY key;
+
+    /* @@ Wine registry key: HKCU\Software\Wine\Direct3D */
+    if (RegOpenKeyA(HKEY_CURRENT_USER, "Software\\Wine\\Direct3D", &key))
+        return;
+    if (!RegQueryValueExA(key, "AssemblyCache", NULL, &type, (BYTE *)buffer, &size)
+            && type == REG_SZ && !strcmp(buffer, "enabled"))
+    {
+        TRACE("Enabling the assembly cache.\n");
+        assembly_cache_enabled = TRUE;
+    }
+    RegCloseKey(key);
+}
+
+static void assembly_cache_cleanup(void)
+{
+    struct assembly_cache_entry *entry, *next;
+
+    LIST_FOR_EACH_ENTRY_SAFE(entry, next, &assembly_cache, struct assembly_cache_entry, entry)
+    {
+        list_remove(&entry->entry);
+        HeapFree(GetProcessHeap(), 0, entry->source);
+        HeapFree(GetProcessHeap(), 0, entry->bytecode);
+        HeapFree(GetProcessHeap(), 0, entry);
+    }
+    assembly_cache_count = 0;
+}
+
+/* Takes ownership of the bytecode. */
+static void assembly_cache_add(const char *source, unsigned int hash, DWORD *bytecode, DWORD size)
+{
+    struct assembly_cache_entry *entry;
+    SIZE_T len = strlen(source) + 1;
+
+    if (!(entry = HeapAlloc(GetProcessHeap(), 0, sizeof(*entry)))
+            || !(entry->source = HeapAlloc(GetProcessHeap(), 0, len)))
+    {
+        HeapFree(GetProcessHeap(), 0, entry);
+        HeapFree(GetProcessHeap(), 0, bytecode);
+        return;
+    }
+    memcpy(entry->source, source, len);
+    entry->hash = hash;
+    entry->bytecode = bytecode;
+    entry->size = size;
+    list_add_head(&assembly_cache, &entry->entry);
+
+    if (++assembly_cache_count > ASSEMBLY_CACHE_SIZE)
+    {
+        entry = LIST_ENTRY(list_tail(&assembly_cache), struct assembly_cache_entry, entry);
+        list_remove(&entry->entry);
+        HeapFree(GetProcessHeap(), 0, entry->source);
+        HeapFree(GetProcessHeap(), 0, entry->bytecode);
+        HeapFree(GetProcessHeap(), 0, entry);
+        --assembly_cache_count;
+    }
+}
+
 static HRESULT assemble_shader(const char *preproc_shader,
         ID3DBlob **shader_blob, ID3DBlob **error_messages)
 {
@@ -640,10 +749,32 @@ static HRESULT assemble_shader(const char *preproc_shader,
     char *messages = NULL;
     HRESULT hr;
     DWORD *res, size;
+    struct assembly_cache_entry *cached;
+    unsigned int hash = 0;
+    BOOL cacheable;
     ID3DBlob *buffer;
     char *pos;
 
+    if (assembly_cache_enabled)
+    {
+        hash = assembly_cache_hash(preproc_shader);
+        if ((cached = assembly_cache_find(preproc_shader, hash)))
+        {
+            TRACE("Using cached bytecode, size %u.\n", cached->size);
+            if (shader_blob)
+            {
+                if (FAILED(hr = D3DCreateBlob(cached->size, &buffer)))
+                    return hr;
+                CopyMemory(ID3D10Blob_GetBufferPointer(buffer), cached->bytecode, cached->size);
+                *shader_blob = buffer;
+            }
+            return S_OK;
+        }
+    }
+
     shader = SlAssembleShader(preproc_shader, &messages);
+    /* Don't cache shaders producing warnings, they would get lost. */
+    cacheable = assembly_cache_enabled && !messages;
 
     if (messages)
     {
@@ -705,7 +836,10 @@ static HRESULT assemble_shader(const char *preproc_shader,
         *shader_blob = buffer;
     }
 
-    HeapFree(GetProcessHeap(), 0, res);
+    if (cacheable)
+        assembly_cache_add(preproc_shader, hash, res, size);
+    else
+        HeapFree(GetProcessHeap(), 0, res);
 
     return S_OK;
 }
@@ -884,3 +1018,21 @@ HRESULT WINAPI D3DLoadModule(const void *data, SIZE_T size, ID3D11Module **modul
     FIXME("data %p, size %lu, module %p stub!\n", data, size, module);
     return E_NOTIMPL;
 }
+
+BOOL WINAPI DllMain(HINSTANCE inst, DWORD reason, void *reserved)
+{
+    switch (reason)
+    {
+        case DLL_PROCESS_ATTACH:
+            DisableThreadLibraryCalls(inst);
+            assembly_cache_init();
+            break;
+
+        case DLL_PROCESS_DETACH:
+            if (reserved)
+                break;
+            assembly_cache_cleanup();
+            break;
+    }
+    return TRUE;
+}
@@ -1220,6 +1220,199 @@ static HRESULT parse_preshader(struct d3dx_preshader *pres, unsigned int *ptr, u
     return D3D_OK;
 }
 
+static double exec_get_reg_value(struct d3dx_regstore *rs, enum pres_reg_tables table, unsigned int offset)
+{
+    return regstore_get_double(rs, table, offset);
+}
+
+static double exec_get_arg(struct d3dx_regstore *rs, const struct d3dx_pres_operand *opr, unsigned int comp)
+{
+    unsigned int offset, base_index, reg_index, table;
+
+    table = opr->reg.table;
+
+    if (opr->index_reg.table == PRES_REGTAB_COUNT)
+        base_index = 0;
+    else
+        base_index = lrint(exec_get_reg_value(rs, opr->index_reg.table, opr->index_reg.offset));
+
+    offset = get_offset_reg(table, base_index) + opr->reg.offset + comp;
+    reg_index = get_reg_offset(table, offset);
+
+    if (reg_index >= rs->table_sizes[table])
+    {
+        unsigned int wrap_size;
+
+        if (table == PRES_REGTAB_CONST)
+        {
+            /* As it can be guessed from tests, offset into floating constant table is wrapped
+             * to the nearest power of 2 and not to the actual table size. */
+            for (wrap_size = 1; wrap_size < rs->table_sizes[table]; wrap_size <<= 1)
+                ;
+        }
+        else
+        {
+            wrap_size = rs->table_sizes[table];
+        }
+        WARN("Wrapping register index %u, table %u, wrap_size %u, table size %u.\n",
+                reg_index, table, wrap_size, rs->table_sizes[table]);
+        reg_index %= wrap_size;
+
+        if (reg_index >= rs->table_sizes[table])
+            return 0.0;
+
+        offset = get_offset_reg(table, reg_index) + offset % get_reg_components(table);
+    }
+
+    return exec_get_reg_value(rs, table, offset);
+}
+
+static void exec_set_arg(struct d3dx_regstore *rs, const struct d3dx_pres_reg *reg,
+        unsigned int comp, double res)
+{
+    regstore_set_double(rs, reg->table, reg->offset + comp, res);
+}
+
+#define ARGS_ARRAY_SIZE 8
+static HRESULT execute_preshader_ins(struct d3dx_preshader *pres, const struct d3dx_pres_ins *ins)
+{
+    const struct op_info *oi = &pres_op_info[ins->op];
+    double args[ARGS_ARRAY_SIZE];
+    unsigned int j, k;
+    double res;
+
+    if (oi->func_all_comps)
+    {
+        if (oi->input_count * ins->component_count > ARGS_ARRAY_SIZE)
+        {
+            FIXME("Too many arguments (%u) for one instruction.\n", oi->input_count * ins->component_count);
+            return E_FAIL;
+        }
+        for (k = 0; k < oi->input_count; ++k)
+            for (j = 0; j < ins->component_count; ++j)
+                args[k * ins->component_count + j] = exec_get_arg(&pres->regs, &ins->inputs[k],
+                        ins->scalar_op && !k ? 0 : j);
+        res = oi->func(args, ins->component_count);
+
+        /* only 'dot' instruction currently falls here */
+        exec_set_arg(&pres->regs, &ins->output.reg, 0, res);
+    }
+    else
+    {
+        for (j = 0; j < ins->component_count; ++j)
+        {
+            for (k = 0; k < oi->input_count; ++k)
+                args[k] = exec_get_arg(&pres->regs, &ins->inputs[k], ins->scalar_op && !k ? 0 : j);
+            res = oi->func(args, ins->component_count);
+            exec_set_arg(&pres->regs, &ins->output.reg, j, res);
+        }
+    }
+    return D3D_OK;
+}
+
+static HRESULT execute_preshader(struct d3dx_preshader *pres)
+{
+    unsigned int i;
+    HRESULT hr;
+
+    for (i = 0; i < pres->ins_count; ++i)
+    {
+        if (FAILED(hr = execute_preshader_ins(pres, &pres->ins[i])))
+            return hr;
+    }
+    return D3D_OK;
+}
+
+static unsigned int get_ins_output_component_count(const struct d3dx_pres_ins *ins)
+{
+    return pres_op_info[ins->op].func_all_comps ? 1 : ins->component_count;
+}
+
+static BOOL is_ins_input_constant(const struct d3dx_pres_ins *ins, const BYTE *temp_constant)
+{
+    unsigned int j, k, comp;
+
+    for (k = 0; k < pres_op_info[ins->op].input_count; ++k)
+    {
+        const struct d3dx_pres_operand *opr = &ins->inputs[k];
+
+        if (opr->index_reg.table != PRES_REGTAB_COUNT)
+            return FALSE;
+        if (opr->reg.table == PRES_REGTAB_IMMED)
+            continue;
+        if (opr->reg.table != PRES_REGTAB_TEMP)
+            return FALSE;
+        for (j = 0; j < ins->component_count; ++j)
+        {
+            comp = ins->scalar_op && !k ? 0 : j;
+            if (!temp_constant[opr->reg.offset + comp])
+                return FALSE;
+        }
+    }
+    return TRUE;
+}
+
+/* Instructions which only read immediate constants, directly or through
+ * temporary registers written once by other such instructions, produce the
+ * same result every time the preshader runs. Execute them once here and
+ * drop them from the program. */
+static HRESULT fold_preshader_constants(struct d3dx_preshader *pres)
+{
+    unsigned int i, j, temp_count, folded_count = 0;
+    unsigned int *write_count;
+    BYTE *temp_constant;
+    HRESULT hr = D3D_OK;
+
+    if (!(temp_count = get_offset_reg(PRES_REGTAB_TEMP, pres->regs.table_sizes[PRES_REGTAB_TEMP])))
+        return D3D_OK;
+
+    write_count = HeapAlloc(GetProcessHeap(), HEAP_ZERO_MEMORY, temp_count * sizeof(*write_count));
+    temp_constant = HeapAlloc(GetProcessHeap(), HEAP_ZERO_MEMORY, temp_count * sizeof(*temp_constant));
+    if (!write_count || !temp_constant)
+    {
+        hr = E_OUTOFMEMORY;
+        goto done;
+    }
+
+    for (i = 0; i < pres->ins_count; ++i)
+    {
+        const struct d3dx_pres_reg *reg = &pres->ins[i].output.reg;
+
+        if (reg->table != PRES_REGTAB_TEMP)
+            continue;
+        for (j = 0; j < get_ins_output_component_count(&pres->ins[i]); ++j)
+            ++write_count[reg->offset + j];
+    }
+
+    for (i = 0; i < pres->ins_count; ++i)
+    {
+        const struct d3dx_pres_ins *ins = &pres->ins[i];
+        unsigned int output_count = get_ins_output_component_count(ins);
+        BOOL constant = ins->output.reg.table == PRES_REGTAB_TEMP && is_ins_input_constant(ins, temp_constant);
+
+        for (j = 0; constant && j < output_count; ++j)
+            constant = write_count[ins->output.reg.offset + j] == 1;
+
+        /* Instructions which can't be executed now are left for runtime. */
+        if (!constant || FAILED(execute_preshader_ins(pres, ins)))
+        {
+            pres->ins[i - folded_count] = *ins;
+            continue;
+        }
+
+        for (j = 0; j < output_count; ++j)
+            temp_constant[ins->output.reg.offset + j] = 1;
+        ++folded_count;
+    }
+    pres->ins_count -= folded_count;
+    TRACE("Folded %u constant instructions.\n", folded_count);
+
+done:
+    HeapFree(GetProcessHeap(), 0, write_count);
+    HeapFree(GetProcessHeap(), 0, temp_constant);
+    return hr;
+}
+
 HRESULT d3dx_create_param_eval(struct d3dx_effect *effect, void *byte_code, unsigned int byte_code_size,
         D3DXPARAMETER_TYPE type, struct d3dx_param_eval **peval_out, ULONG64 *version_counter,
         const char **skip_constants, unsigned int skip_constants_count)
@@ -1306,6 +1499,9 @@ HRESULT d3dx_create_param_eval(struct d3dx_effect *effect, void *byte_code, unsi
             goto err_out;
     }
 
+    if (FAILED(ret = fold_preshader_constants(&peval->pres)))
+        goto err_out;
+
     if (TRACE_ON(d3dx))
     {
         dump_bytecode(byte_code, byte_code_size);
@@ -1592,103 +1788,6 @@ static HRESULT set_constants(struct d3dx_regstore *rs, struct d3dx_const_tab *co
     return result;
 }
 
-static double exec_get_reg_value(struct d3dx_regstore *rs, enum pres_reg_tables table, unsigned int offset)
-{
-    return regstore_get_double(rs, table, offset);
-}
-
-static double exec_get_arg(struct d3dx_regstore *rs, const struct d3dx_pres_operand *opr, unsigned int comp)
-{
-    unsigned int offset, base_index, reg_index, table;
-
-    table = opr->reg.table;
-
-    if (opr->index_reg.table == PRES_REGTAB_COUNT)
-        base_index = 0;
-    else
-        base_index = lrint(exec_get_reg_value(rs, opr->index_reg.table, opr->index_reg.offset));
-
-    offset = get_offset_reg(table, base_index) + opr->reg.offset + comp;
-    reg_index = get_reg_offset(table, offset);
-
-    if (reg_index >= rs->table_sizes[table])
-    {
-        unsigned int wrap_size;
-
-        if (table == PRES_REGTAB_CONST)
-        {
-            /* As it can be guessed from tests, offset into floating constant table is wrapped
-             * to the nearest power of 2 and not to the actual table size. */
-            for (wrap_size = 1; wrap_size < rs->table_sizes[table]; wrap_size <<= 1)
-                ;
-        }
-        else
-        {
-            wrap_size = rs->table_sizes[table];
-        }
-        WARN("Wrapping register index %u, table %u, wrap_size %u, table size %u.\n",
-                reg_index, table, wrap_size, rs->table_sizes[table]);
-        reg_index %= wrap_size;
-
-        if (reg_index >= rs->table_sizes[table])
-            return 0.0;
-
-        offset = get_offset_reg(table, reg_index) + offset % get_reg_components(table);
-    }
-
-    return exec_get_reg_value(rs, table, offset);
-}
-
-static void exec_set_arg(struct d3dx_regstore *rs, const struct d3dx_pres_reg *reg,
-        unsigned int comp, double res)
-{
-    regstore_set_double(rs, reg->table, reg->offset + comp, res);
-}
-
-#define ARGS_ARRAY_SIZE 8
-static HRESULT execute_preshader(struct d3dx_preshader *pres)
-{
-    unsigned int i, j, k;
-    double args[ARGS_ARRAY_SIZE];
-    double res;
-
-    for (i = 0; i < pres->ins_count; ++i)
-    {
-        const struct d3dx_pres_ins *ins;
-        const struct op_info *oi;
-
-        ins = &pres->ins[i];
-        oi = &pres_op_info[ins->op];
-        if (oi->func_all_comps)
-        {
-            if (oi->input_count * ins->component_count > ARGS_ARRAY_SIZE)
-            {
-                FIXME("Too many arguments (%u) for one instruction.\n", oi->input_count * ins->component_count);
-                return E_FAIL;
-            }
-            for (k = 0; k < oi->input_count; ++k)
-                for (j = 0; j < ins->component_count; ++j)
-                    args[k * ins->component_count + j] = exec_get_arg(&pres->regs, &ins->inputs[k],
-                            ins->scalar_op && !k ? 0 : j);
-            res = oi->func(args, ins->component_count);
-
-            /* only 'dot' instruction currently falls here */
-            exec_set_arg(&pres->regs, &ins->output.reg, 0, res);
-        }
-        else
-        {
-            for (j = 0; j < ins->component_count; ++j)
-            {
-                for (k = 0; k < oi->input_count; ++k)
-                    args[k] = exec_get_arg(&pres->regs, &ins->inputs[k], ins->scalar_op && !k ? 0 : j);
-                res = oi->func(args, ins->component_count);
-                exec_set_arg(&pres->regs, &ins->output.reg, j, res);
-            }
-        }
-    }
-    return D3D_OK;
-}
-
 static BOOL is_const_tab_input_dirty(struct d3dx_const_tab *ctab, ULONG64 update_version)
 {
     unsigned int i;
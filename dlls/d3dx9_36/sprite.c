@@ -41,6 +41,7 @@ struct sprite
     D3DXVECTOR3 pos;
     D3DCOLOR color;
     D3DXMATRIX transform;
+    int index;
 };
 
 struct d3dx9_sprite
@@ -51,6 +52,10 @@ struct d3dx9_sprite
     IDirect3DDevice9 *device;
     IDirect3DVertexDeclaration9 *vdecl;
     IDirect3DStateBlock9 *stateblock;
+    IDirect3DVertexBuffer9 *vertex_buffer;
+    UINT vertex_buffer_size; /* in vertices */
+    UINT vertex_buffer_pos;
+    DWORD vertex_buffer_usage;
     D3DXMATRIX transform;
     D3DXMATRIX view;
     DWORD flags;
@@ -128,6 +133,8 @@ static ULONG WINAPI d3dx9_sprite_Release(ID3DXSprite *iface)
             IDirect3DStateBlock9_Release(sprite->stateblock);
         if (sprite->vdecl)
             IDirect3DVertexDeclaration9_Release(sprite->vdecl);
+        if (sprite->vertex_buffer)
+            IDirect3DVertexBuffer9_Release(sprite->vertex_buffer);
         if (sprite->device)
             IDirect3DDevice9_Release(sprite->device);
         HeapFree(GetProcessHeap(), 0, sprite);
@@ -289,7 +296,6 @@ D3DXSPRITE_DONOTMODIFY_RENDERSTATE: name says it all
 D3DXSPRITE_OBJECTSPACE: do not change device transforms
 D3DXSPRITE_SORT_DEPTH_BACKTOFRONT: sort by position
 D3DXSPRITE_SORT_DEPTH_FRONTTOBACK: sort by position
-D3DXSPRITE_SORT_TEXTURE: sort by texture (so that it doesn't change too often)
 */
 /* Seems like alpha blending is always enabled, regardless of D3DXSPRITE_ALPHABLEND flag */
     if(flags & (D3DXSPRITE_BILLBOARD |
@@ -297,7 +303,7 @@ D3DXSPRITE_SORT_TEXTURE: sort by texture (so that it doesn't change too often)
                 D3DXSPRITE_SORT_DEPTH_BACKTOFRONT))
         FIXME("Flags unsupported: %#x\n", flags);
     /* These flags should only matter to performance */
-    else if(flags & (D3DXSPRITE_SORT_DEPTH_FRONTTOBACK | D3DXSPRITE_SORT_TEXTURE))
+    else if(flags & D3DXSPRITE_SORT_DEPTH_FRONTTOBACK)
         TRACE("Flags unsupported: %#x\n", flags);
 
     if(This->vdecl==NULL) {
@@ -401,73 +407,156 @@ static HRESULT WINAPI d3dx9_sprite_Draw(ID3DXSprite *iface, IDirect3DTexture9 *t
 
     This->sprites[This->sprite_count].color=color;
     This->sprites[This->sprite_count].transform=This->transform;
+    This->sprites[This->sprite_count].index=This->sprite_count;
     This->sprite_count++;
 
     return D3D_OK;
 }
 
+static void sprite_get_vertices(const struct sprite *sprite, struct sprite_vertex *vertices)
+{
+    float spritewidth = (float)sprite->rect.right - (float)sprite->rect.left;
+    float spriteheight = (float)sprite->rect.bottom - (float)sprite->rect.top;
+
+    vertices[0].pos.x = sprite->pos.x - sprite->center.x;
+    vertices[0].pos.y = sprite->pos.y - sprite->center.y;
+    vertices[0].pos.z = sprite->pos.z - sprite->center.z;
+    vertices[1].pos.x = spritewidth + sprite->pos.x - sprite->center.x;
+    vertices[1].pos.y = sprite->pos.y - sprite->center.y;
+    vertices[1].pos.z = sprite->pos.z - sprite->center.z;
+    vertices[2].pos.x = spritewidth + sprite->pos.x - sprite->center.x;
+    vertices[2].pos.y = spriteheight + sprite->pos.y - sprite->center.y;
+    vertices[2].pos.z = sprite->pos.z - sprite->center.z;
+    vertices[3].pos.x = sprite->pos.x - sprite->center.x;
+    vertices[3].pos.y = spriteheight + sprite->pos.y - sprite->center.y;
+    vertices[3].pos.z = sprite->pos.z - sprite->center.z;
+    vertices[0].col   = sprite->color;
+    vertices[1].col   = sprite->color;
+    vertices[2].col   = sprite->color;
+    vertices[3].col   = sprite->color;
+    vertices[0].tex.x = (float)sprite->rect.left / (float)sprite->texw;
+    vertices[0].tex.y = (float)sprite->rect.top / (float)sprite->texh;
+    vertices[1].tex.x = (float)sprite->rect.right / (float)sprite->texw;
+    vertices[1].tex.y = (float)sprite->rect.top / (float)sprite->texh;
+    vertices[2].tex.x = (float)sprite->rect.right / (float)sprite->texw;
+    vertices[2].tex.y = (float)sprite->rect.bottom / (float)sprite->texh;
+    vertices[3].tex.x = (float)sprite->rect.left / (float)sprite->texw;
+    vertices[3].tex.y = (float)sprite->rect.bottom / (float)sprite->texh;
+
+    vertices[4] = vertices[0];
+    vertices[5] = vertices[2];
+
+    D3DXVec3TransformCoordArray(&vertices[0].pos, sizeof(*vertices),
+            &vertices[0].pos, sizeof(*vertices), &sprite->transform, 6);
+}
+
+static int __cdecl sprite_texture_compare(const void *a, const void *b)
+{
+    const struct sprite *sprite_a = a, *sprite_b = b;
+
+    if (sprite_a->texture != sprite_b->texture)
+        return sprite_a->texture < sprite_b->texture ? -1 : 1;
+    /* Keep the submission order for sprites using the same texture. */
+    return sprite_a->index - sprite_b->index;
+}
+
+/* Vertices are appended to a dynamic vertex buffer which is kept across
+ * flushes and only discarded once it is full, so that locking it doesn't
+ * have to wait for previously submitted draws. */
+static HRESULT sprite_lock_vertices(struct d3dx9_sprite *sprite, UINT count,
+        struct sprite_vertex **vertices, UINT *start)
+{
+    DWORD lock_flags = D3DLOCK_NOOVERWRITE;
+    HRESULT hr;
+
+    if (count > sprite->vertex_buffer_size)
+    {
+        UINT size = max(sprite->vertex_buffer_size * 2, 6 * 256);
+
+        while (size < count)
+            size *= 2;
+
+        if (sprite->vertex_buffer)
+            IDirect3DVertexBuffer9_Release(sprite->vertex_buffer);
+        sprite->vertex_buffer_size = 0;
+        if (FAILED(hr = IDirect3DDevice9_CreateVertexBuffer(sprite->device, size * sizeof(**vertices),
+                sprite->vertex_buffer_usage, 0, D3DPOOL_DEFAULT, &sprite->vertex_buffer, NULL)))
+        {
+            WARN("Failed to create vertex buffer, hr %#x.\n", hr);
+            sprite->vertex_buffer = NULL;
+            return hr;
+        }
+        sprite->vertex_buffer_size = size;
+        sprite->vertex_buffer_pos = size;
+    }
+
+    if (sprite->vertex_buffer_size - sprite->vertex_buffer_pos < count)
+    {
+        sprite->vertex_buffer_pos = 0;
+        lock_flags = D3DLOCK_DISCARD;
+    }
+
+    if (FAILED(hr = IDirect3DVertexBuffer9_Lock(sprite->vertex_buffer, sprite->vertex_buffer_pos * sizeof(**vertices),
+            count * sizeof(**vertices), (void **)vertices, lock_flags)))
+        return hr;
+
+    *start = sprite->vertex_buffer_pos;
+    sprite->vertex_buffer_pos += count;
+    return D3D_OK;
+}
+
 static HRESULT WINAPI d3dx9_sprite_Flush(ID3DXSprite *iface)
 {
     struct d3dx9_sprite *This = impl_from_ID3DXSprite(iface);
     struct sprite_vertex *vertices;
     int i, count=0, start;
+    BOOL use_vertex_buffer;
+    UINT base_vertex;
 
     TRACE("iface %p.\n", iface);
 
     if(!This->ready) return D3DERR_INVALIDCALL;
     if(!This->sprite_count) return D3D_OK;
 
-/* TODO: use of a vertex buffer here */
-    vertices = HeapAlloc(GetProcessHeap(), 0, sizeof(*vertices) * 6 * This->sprite_count);
+    /* Depth sorting takes precedence over texture sorting. */
+    if ((This->flags & D3DXSPRITE_SORT_TEXTURE)
+            && !(This->flags & (D3DXSPRITE_SORT_DEPTH_FRONTTOBACK | D3DXSPRITE_SORT_DEPTH_BACKTOFRONT)))
+        qsort(This->sprites, This->sprite_count, sizeof(*This->sprites), sprite_texture_compare);
+
+    use_vertex_buffer = SUCCEEDED(sprite_lock_vertices(This, 6 * This->sprite_count, &vertices, &base_vertex));
+    if (!use_vertex_buffer
+            && !(vertices = HeapAlloc(GetProcessHeap(), 0, sizeof(*vertices) * 6 * This->sprite_count)))
+        return E_OUTOFMEMORY;
+
+    for (i = 0; i < This->sprite_count; ++i)
+        sprite_get_vertices(&This->sprites[i], &vertices[6 * i]);
+
+    IDirect3DDevice9_SetVertexDeclaration(This->device, This->vdecl);
+    if (use_vertex_buffer)
+    {
+        IDirect3DVertexBuffer9_Unlock(This->vertex_buffer);
+        IDirect3DDevice9_SetStreamSource(This->device, 0, This->vertex_buffer, 0, sizeof(*vertices));
+    }
 
     for(start=0;start<This->sprite_count;start+=count,count=0) {
         i=start;
         while(i<This->sprite_count &&
               (count==0 || This->sprites[i].texture==This->sprites[i-1].texture)) {
-            float spritewidth=(float)This->sprites[i].rect.right-(float)This->sprites[i].rect.left;
-            float spriteheight=(float)This->sprites[i].rect.bottom-(float)This->sprites[i].rect.top;
-
-            vertices[6*i  ].pos.x = This->sprites[i].pos.x - This->sprites[i].center.x;
-            vertices[6*i  ].pos.y = This->sprites[i].pos.y - This->sprites[i].center.y;
-            vertices[6*i  ].pos.z = This->sprites[i].pos.z - This->sprites[i].center.z;
-            vertices[6*i+1].pos.x = spritewidth + This->sprites[i].pos.x - This->sprites[i].center.x;
-            vertices[6*i+1].pos.y = This->sprites[i].pos.y - This->sprites[i].center.y;
-            vertices[6*i+1].pos.z = This->sprites[i].pos.z - This->sprites[i].center.z;
-            vertices[6*i+2].pos.x = spritewidth + This->sprites[i].pos.x - This->sprites[i].center.x;
-            vertices[6*i+2].pos.y = spriteheight + This->sprites[i].pos.y - This->sprites[i].center.y;
-            vertices[6*i+2].pos.z = This->sprites[i].pos.z - This->sprites[i].center.z;
-            vertices[6*i+3].pos.x = This->sprites[i].pos.x - This->sprites[i].center.x;
-            vertices[6*i+3].pos.y = spriteheight + This->sprites[i].pos.y - This->sprites[i].center.y;
-            vertices[6*i+3].pos.z = This->sprites[i].pos.z - This->sprites[i].center.z;
-            vertices[6*i  ].col   = This->sprites[i].color;
-            vertices[6*i+1].col   = This->sprites[i].color;
-            vertices[6*i+2].col   = This->sprites[i].color;
-            vertices[6*i+3].col   = This->sprites[i].color;
-            vertices[6*i  ].tex.x = (float)This->sprites[i].rect.left / (float)This->sprites[i].texw;
-            vertices[6*i  ].tex.y = (float)This->sprites[i].rect.top / (float)This->sprites[i].texh;
-            vertices[6*i+1].tex.x = (float)This->sprites[i].rect.right / (float)This->sprites[i].texw;
-            vertices[6*i+1].tex.y = (float)This->sprites[i].rect.top / (float)This->sprites[i].texh;
-            vertices[6*i+2].tex.x = (float)This->sprites[i].rect.right / (float)This->sprites[i].texw;
-            vertices[6*i+2].tex.y = (float)This->sprites[i].rect.bottom / (float)This->sprites[i].texh;
-            vertices[6*i+3].tex.x = (float)This->sprites[i].rect.left / (float)This->sprites[i].texw;
-            vertices[6*i+3].tex.y = (float)This->sprites[i].rect.bottom / (float)This->sprites[i].texh;
-
-            vertices[6*i+4]=vertices[6*i];
-            vertices[6*i+5]=vertices[6*i+2];
-
-            D3DXVec3TransformCoordArray(&vertices[6 * i].pos, sizeof(*vertices),
-                    &vertices[6 * i].pos, sizeof(*vertices), &This->sprites[i].transform, 6);
             count++;
             i++;
         }
 
         IDirect3DDevice9_SetTexture(This->device, 0, (struct IDirect3DBaseTexture9 *)This->sprites[start].texture);
-        IDirect3DDevice9_SetVertexDeclaration(This->device, This->vdecl);
 
-        IDirect3DDevice9_DrawPrimitiveUP(This->device, D3DPT_TRIANGLELIST,
-                2 * count, vertices + 6 * start, sizeof(*vertices));
+        if (use_vertex_buffer)
+            IDirect3DDevice9_DrawPrimitive(This->device, D3DPT_TRIANGLELIST,
+                    base_vertex + 6 * start, 2 * count);
+        else
+            IDirect3DDevice9_DrawPrimitiveUP(This->device, D3DPT_TRIANGLELIST,
+                    2 * count, vertices + 6 * start, sizeof(*vertices));
     }
-    HeapFree(GetProcessHeap(), 0, vertices);
+    if (!use_vertex_buffer)
+        HeapFree(GetProcessHeap(), 0, vertices);
 
     if(!(This->flags & D3DXSPRITE_DO_NOT_ADDREF_TEXTURE))
         for(i=0;i<This->sprite_count;i++)
@@ -509,8 +598,12 @@ static HRESULT WINAPI d3dx9_sprite_OnLostDevice(ID3DXSprite *iface)
         IDirect3DStateBlock9_Release(sprite->stateblock);
     if (sprite->vdecl)
         IDirect3DVertexDeclaration9_Release(sprite->vdecl);
+    if (sprite->vertex_buffer)
+        IDirect3DVertexBuffer9_Release(sprite->vertex_buffer);
     sprite->vdecl = NULL;
     sprite->stateblock = NULL;
+    sprite->vertex_buffer = NULL;
+    sprite->vertex_buffer_size = 0;
 
     /* Reset some variables */
     ID3DXSprite_OnResetDevice(iface);
@@ -564,6 +657,7 @@ static const ID3DXSpriteVtbl d3dx9_sprite_vtbl =
 
 HRESULT WINAPI D3DXCreateSprite(struct IDirect3DDevice9 *device, struct ID3DXSprite **sprite)
 {
+    D3DDEVICE_CREATION_PARAMETERS params;
     struct d3dx9_sprite *object;
     D3DCAPS9 caps;
 
@@ -592,6 +686,11 @@ HRESULT WINAPI D3DXCreateSprite(struct IDirect3DDevice9 *device, struct ID3DXSpr
     object->maxanisotropy=caps.MaxAnisotropy;
     object->alphacmp_caps=caps.AlphaCmpCaps;
 
+    object->vertex_buffer_usage = D3DUSAGE_DYNAMIC | D3DUSAGE_WRITEONLY;
+    if (SUCCEEDED(IDirect3DDevice9_GetCreationParameters(device, &params))
+            && params.BehaviorFlags & (D3DCREATE_SOFTWARE_VERTEXPROCESSING | D3DCREATE_MIXED_VERTEXPROCESSING))
+        object->vertex_buffer_usage |= D3DUSAGE_SOFTWAREPROCESSING;
+
     ID3DXSprite_OnResetDevice(&object->ID3DXSprite_iface);
 
     object->sprites=NULL;
@@ -1481,6 +1481,8 @@ struct argb_conversion_info
     DWORD srcmask[4], destmask[4];
     BOOL process_channel[4];
     DWORD channelmask;
+    /* All converted channels have the same width in both formats. */
+    BOOL same_widths;
 };
 
 static void init_argb_conversion_info(const struct pixel_format_desc *srcformat, const struct pixel_format_desc *destformat, struct argb_conversion_info *info)
@@ -1488,6 +1490,7 @@ static void init_argb_conversion_info(const struct pixel_format_desc *srcformat,
     UINT i;
     ZeroMemory(info->process_channel, 4 * sizeof(BOOL));
     info->channelmask = 0;
+    info->same_widths = TRUE;
 
     info->srcformat  =  srcformat;
     info->destformat = destformat;
@@ -1507,6 +1510,8 @@ static void init_argb_conversion_info(const struct pixel_format_desc *srcformat,
             if(srcformat->bits[i]) info->process_channel[i] = TRUE;
             else info->channelmask |= info->destmask[i];
         }
+        if (info->process_channel[i] && srcformat->bits[i] != destformat->bits[i])
+            info->same_widths = FALSE;
     }
 }
 
@@ -1563,6 +1568,34 @@ static DWORD make_argb_color(const struct argb_conversion_info *info, const DWOR
     return val;
 }
 
+/************************************************************
+ * convert_argb_color
+ *
+ * Converts a single pixel between the formats of the conversion info.
+ * When channel widths don't change, e.g. between the various 8 bits per
+ * channel formats, this only needs to move the channels around.
+ */
+static DWORD convert_argb_color(const struct argb_conversion_info *info, const BYTE *col, DWORD *channels)
+{
+    DWORD src = 0, val;
+    unsigned int i;
+
+    if (!info->same_widths)
+    {
+        get_relevant_argb_components(info, col, channels);
+        return make_argb_color(info, channels);
+    }
+
+    memcpy(&src, col, info->srcformat->bytes_per_pixel);
+    val = info->channelmask;
+    for (i = 0; i < 4; ++i)
+    {
+        if (info->process_channel[i])
+            val |= ((src & info->srcmask[i]) >> info->srcshift[i]) << info->destshift[i];
+    }
+    return val;
+}
+
 /* It doesn't work for components bigger than 32 bits (or somewhat smaller but unaligned). */
 static void format_to_vec4(const struct pixel_format_desc *format, const BYTE *src, struct vec4 *dst)
 {
@@ -1685,6 +1718,7 @@ void convert_argb_pixels(const BYTE *src, UINT src_row_pitch, UINT src_slice_pit
     DWORD channels[4];
     UINT min_width, min_height, min_depth;
     UINT x, y, z;
+    BOOL simple;
 
     TRACE("src %p, src_row_pitch %u, src_slice_pitch %u, src_size %p, src_format %p, dst %p, "
             "dst_row_pitch %u, dst_slice_pitch %u, dst_size %p, dst_format %p, color_key 0x%08x, palette %p.\n",
@@ -1693,6 +1727,8 @@ void convert_argb_pixels(const BYTE *src, UINT src_row_pitch, UINT src_slice_pit
 
     ZeroMemory(channels, sizeof(channels));
     init_argb_conversion_info(src_format, dst_format, &conv_info);
+    simple = !src_format->to_rgba && !dst_format->from_rgba && src_format->type == dst_format->type
+            && src_format->bytes_per_pixel <= 4 && dst_format->bytes_per_pixel <= 4;
 
     min_width = min(src_size->width, dst_size->width);
     min_height = min(src_size->height, dst_size->height);
@@ -1714,24 +1750,13 @@ void convert_argb_pixels(const BYTE *src, UINT src_row_pitch, UINT src_slice_pit
             BYTE *dst_ptr = dst_slice_ptr + y * dst_row_pitch;
 
             for (x = 0; x < min_width; x++) {
-                if (!src_format->to_rgba && !dst_format->from_rgba
-                        && src_format->type == dst_format->type
-                        && src_format->bytes_per_pixel <= 4 && dst_format->bytes_per_pixel <= 4)
+                if (simple)
                 {
                     DWORD val;
 
-                    get_relevant_argb_components(&conv_info, src_ptr, channels);
-                    val = make_argb_color(&conv_info, channels);
-
-                    if (color_key)
-                    {
-                        DWORD ck_pixel;
-
-                        get_relevant_argb_components(&ck_conv_info, src_ptr, channels);
-                        ck_pixel = make_argb_color(&ck_conv_info, channels);
-                        if (ck_pixel == color_key)
-                            val &= ~conv_info.destmask[0];
-                    }
+                    val = convert_argb_color(&conv_info, src_ptr, channels);
+                    if (color_key && convert_argb_color(&ck_conv_info, src_ptr, channels) == color_key)
+                        val &= ~conv_info.destmask[0];
                     memcpy(dst_ptr, &val, dst_format->bytes_per_pixel);
                 }
                 else
@@ -1792,6 +1817,7 @@ void point_filter_argb_pixels(const BYTE *src, UINT src_row_pitch, UINT src_slic
     const struct pixel_format_desc *ck_format = NULL;
     DWORD channels[4];
     UINT x, y, z;
+    BOOL simple;
 
     TRACE("src %p, src_row_pitch %u, src_slice_pitch %u, src_size %p, src_format %p, dst %p, "
             "dst_row_pitch %u, dst_slice_pitch %u, dst_size %p, dst_format %p, color_key 0x%08x, palette %p.\n",
@@ -1800,6 +1826,8 @@ void point_filter_argb_pixels(const BYTE *src, UINT src_row_pitch, UINT src_slic
 
     ZeroMemory(channels, sizeof(channels));
     init_argb_conversion_info(src_format, dst_format, &conv_info);
+    simple = !src_format->to_rgba && !dst_format->from_rgba && src_format->type == dst_format->type
+            && src_format->bytes_per_pixel <= 4 && dst_format->bytes_per_pixel <= 4;
 
     if (color_key)
     {
@@ -1822,24 +1850,13 @@ void point_filter_argb_pixels(const BYTE *src, UINT src_row_pitch, UINT src_slic
             {
                 const BYTE *src_ptr = src_row_ptr + (x * src_size->width / dst_size->width) * src_format->bytes_per_pixel;
 
-                if (!src_format->to_rgba && !dst_format->from_rgba
-                        && src_format->type == dst_format->type
-                        && src_format->bytes_per_pixel <= 4 && dst_format->bytes_per_pixel <= 4)
+                if (simple)
                 {
                     DWORD val;
 
-                    get_relevant_argb_components(&conv_info, src_ptr, channels);
-                    val = make_argb_color(&conv_info, channels);
-
-                    if (color_key)
-                    {
-                        DWORD ck_pixel;
-
-                        get_relevant_argb_components(&ck_conv_info, src_ptr, channels);
-                        ck_pixel = make_argb_color(&ck_conv_info, channels);
-                        if (ck_pixel == color_key)
-                            val &= ~conv_info.destmask[0];
-                    }
+                    val = convert_argb_color(&conv_info, src_ptr, channels);
+                    if (color_key && convert_argb_color(&ck_conv_info, src_ptr, channels) == color_key)
+                        val &= ~conv_info.destmask[0];
                     memcpy(dst_ptr, &val, dst_format->bytes_per_pixel);
                 }
                 else
@@ -1875,6 +1892,64 @@ void point_filter_argb_pixels(const BYTE *src, UINT src_row_pitch, UINT src_slic
     }
 }
 
+struct dxtn_compress_context
+{
+    const BYTE *src;
+    BYTE *dst;
+    unsigned int width, height;
+    unsigned int dst_pitch;
+    unsigned int band_height;
+    GLenum format;
+    LONG next_band;
+};
+
+static void CALLBACK dxtn_compress_bands(TP_CALLBACK_INSTANCE *instance, void *context, TP_WORK *work)
+{
+    struct dxtn_compress_context *ctx = context;
+    unsigned int y;
+
+    while ((y = (InterlockedIncrement(&ctx->next_band) - 1) * ctx->band_height) < ctx->height)
+    {
+        tx_compress_dxtn(4, ctx->width, min(ctx->band_height, ctx->height - y),
+                ctx->src + y * ctx->width * 4, ctx->format, ctx->dst + (y / 4) * ctx->dst_pitch, ctx->dst_pitch);
+    }
+}
+
+/* Blocks are compressed independently of each other, so large surfaces are
+ * split into bands of block rows and compressed on the thread pool. */
+static void compress_dxtn(unsigned int width, unsigned int height, const BYTE *src,
+        GLenum format, BYTE *dst, unsigned int dst_pitch)
+{
+    struct dxtn_compress_context ctx;
+    unsigned int band_count, i;
+    SYSTEM_INFO info;
+    TP_WORK *work;
+
+    GetSystemInfo(&info);
+    if (info.dwNumberOfProcessors < 2 || width * height < 256 * 256
+            || !(work = CreateThreadpoolWork(dxtn_compress_bands, &ctx, NULL)))
+    {
+        tx_compress_dxtn(4, width, height, src, format, dst, dst_pitch);
+        return;
+    }
+
+    band_count = info.dwNumberOfProcessors * 4;
+    ctx.src = src;
+    ctx.dst = dst;
+    ctx.width = width;
+    ctx.height = height;
+    ctx.dst_pitch = dst_pitch;
+    ctx.band_height = max(4, ((height + band_count - 1) / band_count + 3) & ~3);
+    ctx.format = format;
+    ctx.next_band = 0;
+
+    for (i = 1; i < info.dwNumberOfProcessors; ++i)
+        SubmitThreadpoolWork(work);
+    dxtn_compress_bands(NULL, &ctx, work);
+    WaitForThreadpoolWorkCallbacks(work, FALSE);
+    CloseThreadpoolWork(work);
+}
+
 /************************************************************
  * D3DXLoadSurfaceFromMemory
  *
@@ -2145,9 +2220,8 @@ HRESULT WINAPI D3DXLoadSurfaceFromMemory(IDirect3DSurface9 *dst_surface,
                 default:
                     ERR("Unexpected destination compressed format %u.\n", surfdesc.Format);
             }
-            tx_compress_dxtn(4, dst_size_aligned.width, dst_size_aligned.height,
-                    dst_uncompressed, gl_format, lockrect.pBits,
-                    lockrect.Pitch * destformatdesc->block_width / destformatdesc->block_byte_count);
+            compress_dxtn(dst_size_aligned.width, dst_size_aligned.height,
+                    dst_uncompressed, gl_format, lockrect.pBits, lockrect.Pitch);
             heap_free(dst_uncompressed);
         }
     }
@@ -496,7 +496,7 @@ static void CDECL dib_surface_set_region( struct window_surface *window_surface,
  */
 static void CDECL dib_surface_flush( struct window_surface *window_surface )
 {
-    /* nothing to do */
+    window_surface->damage.count = 0;
 }
 
 /***********************************************************************
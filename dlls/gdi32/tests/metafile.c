@@ -9140,6 +9140,54 @@ static void test_SetEnhMetaFileBits(void)
     DeleteEnhMetaFile(hemf);
 }
 
+static int CALLBACK zero_size_record_enum_proc(HDC hdc, HANDLETABLE *handle_table,
+        const ENHMETARECORD *emr, int n_objs, LPARAM param)
+{
+    unsigned int *count = (unsigned int *)param;
+
+    if (!(*count)++)
+        ok(emr->iType == EMR_HEADER, "Got unexpected record type %u.\n", emr->iType);
+    else
+        ok(emr->iType == EMR_SETBKMODE && !emr->nSize, "Got unexpected record type %u, size %u.\n",
+                emr->iType, emr->nSize);
+    return *count < 4;
+}
+
+static void test_emf_zero_size_record(void)
+{
+    unsigned int count = 0;
+    HENHMETAFILE hemf;
+    ENHMETAHEADER *emh;
+    ENHMETARECORD *emr;
+    BYTE data[256];
+    BOOL ret;
+
+    emh = (ENHMETAHEADER *)data;
+    memset(emh, 0, sizeof(*emh));
+    emh->iType = EMR_HEADER;
+    emh->nSize = sizeof(*emh);
+    emh->dSignature = ENHMETA_SIGNATURE;
+    emh->nVersion = 0x10000;
+    emh->nBytes = sizeof(*emh) + 2 * sizeof(DWORD);
+    emh->nRecords = 2;
+    emh->nHandles = 1;
+
+    emr = (ENHMETARECORD *)(emh + 1);
+    emr->iType = EMR_SETBKMODE;
+    emr->nSize = 0;
+
+    hemf = SetEnhMetaFileBits(emh->nBytes, data);
+    ok(!!hemf, "SetEnhMetaFileBits error %u\n", GetLastError());
+
+    /* A zero-sized record doesn't end the enumeration, it's passed to the
+     * callback again until the callback stops. */
+    ret = EnumEnhMetaFile(NULL, hemf, zero_size_record_enum_proc, &count, NULL);
+    ok(!ret, "EnumEnhMetaFile succeeded.\n");
+    ok(count == 4, "Got unexpected count %u.\n", count);
+
+    DeleteEnhMetaFile(hemf);
+}
+
 static void test_emf_polybezier(void)
 {
     HDC hdcMetafile;
@@ -10664,4 +10712,5 @@ START_TEST(metafile)
 
     test_gdiis();
     test_SetEnhMetaFileBits();
+    test_emf_zero_size_record();
 }
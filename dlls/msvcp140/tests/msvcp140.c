@@ -198,6 +198,15 @@ static ULONG (__cdecl *p__Winerror_message)(ULONG, char*, ULONG);
 static int (__cdecl *p__Winerror_map)(int);
 static const char* (__cdecl *p__Syserror_map)(int err);
 
+static unsigned int (WINAPI *p__std_parallel_algorithms_hw_threads)(void);
+static PTP_WORK (WINAPI *p__std_create_threadpool_work)(PTP_WORK_CALLBACK, void*, PTP_CALLBACK_ENVIRON);
+static void (WINAPI *p__std_submit_threadpool_work)(PTP_WORK);
+static void (WINAPI *p__std_bulk_submit_threadpool_work)(PTP_WORK, size_t);
+static void (WINAPI *p__std_close_threadpool_work)(PTP_WORK);
+static void (WINAPI *p__std_wait_for_threadpool_work_callbacks)(PTP_WORK, MSVCP_bool);
+static void (WINAPI *p__std_execution_wait_on_uchar)(const volatile unsigned char*, unsigned char);
+static void (WINAPI *p__std_execution_wake_by_address_all)(const volatile void*);
+
 static BOOLEAN (WINAPI *pCreateSymbolicLinkW)(const WCHAR *, const WCHAR *, DWORD);
 
 static HMODULE msvcp;
@@ -291,6 +300,15 @@ static BOOL init(void)
     SET(p_To_wide, "_To_wide");
     SET(p_Unlink, "_Unlink");
 
+    SETNOFAIL(p__std_parallel_algorithms_hw_threads, "__std_parallel_algorithms_hw_threads");
+    SETNOFAIL(p__std_create_threadpool_work, "__std_create_threadpool_work");
+    SETNOFAIL(p__std_submit_threadpool_work, "__std_submit_threadpool_work");
+    SETNOFAIL(p__std_bulk_submit_threadpool_work, "__std_bulk_submit_threadpool_work");
+    SETNOFAIL(p__std_close_threadpool_work, "__std_close_threadpool_work");
+    SETNOFAIL(p__std_wait_for_threadpool_work_callbacks, "__std_wait_for_threadpool_work_callbacks");
+    SETNOFAIL(p__std_execution_wait_on_uchar, "__std_execution_wait_on_uchar");
+    SETNOFAIL(p__std_execution_wake_by_address_all, "__std_execution_wake_by_address_all");
+
     hdll = GetModuleHandleA("kernel32.dll");
     pCreateSymbolicLinkW = (void*)GetProcAddress(hdll, "CreateSymbolicLinkW");
 
@@ -561,6 +579,48 @@ static void test_chore(void)
     CloseHandle(event);
 }
 
+static void WINAPI parallel_work_callback(PTP_CALLBACK_INSTANCE instance, void *context, PTP_WORK work)
+{
+    InterlockedIncrement(context);
+}
+
+static void test_parallel_algorithms(void)
+{
+    volatile unsigned char flag = 1;
+    unsigned int threads;
+    LONG count = 0;
+    PTP_WORK work;
+
+    if(!p__std_parallel_algorithms_hw_threads)
+    {
+        win_skip("parallel algorithms support functions not available\n");
+        return;
+    }
+
+    threads = p__std_parallel_algorithms_hw_threads();
+    ok(threads > 0, "__std_parallel_algorithms_hw_threads returned %u\n", threads);
+
+    work = p__std_create_threadpool_work(parallel_work_callback, &count, NULL);
+    ok(work != NULL, "__std_create_threadpool_work failed\n");
+
+    p__std_submit_threadpool_work(work);
+    p__std_wait_for_threadpool_work_callbacks(work, FALSE);
+    ok(count == 1, "count = %d\n", count);
+
+    p__std_bulk_submit_threadpool_work(work, 16);
+    p__std_wait_for_threadpool_work_callbacks(work, FALSE);
+    ok(count == 17, "count = %d\n", count);
+
+    p__std_bulk_submit_threadpool_work(work, 0);
+    p__std_wait_for_threadpool_work_callbacks(work, FALSE);
+    ok(count == 17, "count = %d\n", count);
+    p__std_close_threadpool_work(work);
+
+    /* value differs from the comparand, must return immediately */
+    p__std_execution_wait_on_uchar(&flag, 0);
+    p__std_execution_wake_by_address_all(&flag);
+}
+
 static void test_to_byte(void)
 {
     static const WCHAR *tests[] = {L"TEST", L"\x9580\x9581\x9582\x9583"};
@@ -1395,6 +1455,7 @@ START_TEST(msvcp140)
     test__ContextCallback();
     test__TaskEventLogger();
     test_chore();
+    test_parallel_algorithms();
     test_to_byte();
     test_to_wide();
     test_File_size();
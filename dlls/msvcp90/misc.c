@@ -1615,6 +1615,80 @@ LONGLONG __cdecl _Query_perf_frequency(void)
     QueryPerformanceFrequency(&li);
     return li.QuadPart;
 }
+
+/*********************************************************************
+ *  __std_parallel_algorithms_hw_threads (MSVCP140.@)
+ */
+unsigned int WINAPI __std_parallel_algorithms_hw_threads(void)
+{
+    TRACE("()\n");
+    return _Thrd_hardware_concurrency();
+}
+
+/*********************************************************************
+ *  __std_create_threadpool_work (MSVCP140.@)
+ */
+PTP_WORK WINAPI __std_create_threadpool_work(PTP_WORK_CALLBACK callback,
+        void *context, PTP_CALLBACK_ENVIRON environment)
+{
+    TRACE("(%p %p %p)\n", callback, context, environment);
+    return CreateThreadpoolWork(callback, context, environment);
+}
+
+/*********************************************************************
+ *  __std_submit_threadpool_work (MSVCP140.@)
+ */
+void WINAPI __std_submit_threadpool_work(PTP_WORK work)
+{
+    TRACE("(%p)\n", work);
+    SubmitThreadpoolWork(work);
+}
+
+/*********************************************************************
+ *  __std_bulk_submit_threadpool_work (MSVCP140.@)
+ */
+void WINAPI __std_bulk_submit_threadpool_work(PTP_WORK work, size_t count)
+{
+    TRACE("(%p %Iu)\n", work, count);
+    while(count--)
+        SubmitThreadpoolWork(work);
+}
+
+/*********************************************************************
+ *  __std_close_threadpool_work (MSVCP140.@)
+ */
+void WINAPI __std_close_threadpool_work(PTP_WORK work)
+{
+    TRACE("(%p)\n", work);
+    CloseThreadpoolWork(work);
+}
+
+/*********************************************************************
+ *  __std_wait_for_threadpool_work_callbacks (MSVCP140.@)
+ */
+void WINAPI __std_wait_for_threadpool_work_callbacks(PTP_WORK work, bool cancel)
+{
+    TRACE("(%p %d)\n", work, cancel);
+    WaitForThreadpoolWorkCallbacks(work, cancel);
+}
+
+/*********************************************************************
+ *  __std_execution_wait_on_uchar (MSVCP140.@)
+ */
+void WINAPI __std_execution_wait_on_uchar(const volatile unsigned char *addr, unsigned char cmp)
+{
+    TRACE("(%p %u)\n", addr, cmp);
+    RtlWaitOnAddress((const void *)addr, &cmp, sizeof(cmp), NULL);
+}
+
+/*********************************************************************
+ *  __std_execution_wake_by_address_all (MSVCP140.@)
+ */
+void WINAPI __std_execution_wake_by_address_all(const volatile void *addr)
+{
+    TRACE("(%p)\n", addr);
+    RtlWakeAddressAll((const void *)addr);
+}
 #endif
 
 void __cdecl threads__Mtx_new(void **mtx)
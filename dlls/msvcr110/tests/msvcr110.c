@@ -48,6 +48,7 @@ static unsigned int (CDECL *p_CurrentScheduler_GetNumberOfVirtualProcessors)(voi
 static unsigned int (CDECL *p__CurrentScheduler__GetNumberOfVirtualProcessors)(void);
 static unsigned int (CDECL *p_CurrentScheduler_Id)(void);
 static unsigned int (CDECL *p__CurrentScheduler__Id)(void);
+static void (CDECL *p_CurrentScheduler_ScheduleTask)(void (__cdecl *)(void*), void*);
 
 static Context* (__cdecl *p_Context_CurrentContext)(void);
 static _Context* (__cdecl *p__Context__CurrentContext)(_Context*);
@@ -78,10 +79,12 @@ static BOOL init(void)
     if(sizeof(void*) == 8)
     {
         SET(p_Context_CurrentContext, "?CurrentContext@Context@Concurrency@@SAPEAV12@XZ");
+        SET(p_CurrentScheduler_ScheduleTask, "?ScheduleTask@CurrentScheduler@Concurrency@@SAXP6AXPEAX@Z0@Z");
     }
     else
     {
         SET(p_Context_CurrentContext, "?CurrentContext@Context@Concurrency@@SAPAV12@XZ");
+        SET(p_CurrentScheduler_ScheduleTask, "?ScheduleTask@CurrentScheduler@Concurrency@@SAXP6AXPAX@Z0@Z");
     }
 
     return TRUE;
@@ -184,6 +187,39 @@ static void test_CurrentContext(void)
     ok(ret == &_ctx, "expected %p, got %p\n", &_ctx, ret);
 }
 
+struct schedule_task_data
+{
+    HANDLE event;
+    unsigned int scheduler_id;
+    LONG count;
+};
+
+static void __cdecl schedule_task_proc(void *arg)
+{
+    struct schedule_task_data *data = arg;
+
+    data->scheduler_id = p_CurrentScheduler_Id();
+    if (!InterlockedDecrement(&data->count))
+        SetEvent(data->event);
+}
+
+static void test_ScheduleTask(void)
+{
+    struct schedule_task_data data;
+    unsigned int i;
+    DWORD ret;
+
+    data.event = CreateEventW(NULL, TRUE, FALSE, NULL);
+    data.scheduler_id = ~0u;
+    data.count = 16;
+    for (i = 0; i < 16; ++i)
+        p_CurrentScheduler_ScheduleTask(schedule_task_proc, &data);
+    ret = WaitForSingleObject(data.event, 5000);
+    ok(ret == WAIT_OBJECT_0, "WaitForSingleObject returned %u.\n", ret);
+    ok(data.scheduler_id == p_CurrentScheduler_Id(), "Got unexpected scheduler id %u.\n", data.scheduler_id);
+    CloseHandle(data.event);
+}
+
 START_TEST(msvcr110)
 {
     if (!init()) return;
@@ -191,4 +227,5 @@ START_TEST(msvcr110)
     test_setlocale();
     test___strncnt();
     test_CurrentContext();
+    test_ScheduleTask();
 }
@@ -2838,7 +2838,32 @@ static int read_i(int fd, ioinfo *fdinfo, void *buf, unsigned int count)
             else
                 fdinfo->wxflag &= ~WX_READNL;
 
-            for (i=0, j=0; i<num_read; i+=1+utf16)
+            i = j = 0;
+            if (!utf16)
+            {
+                /* Everything before a ctrl-z or the last byte, which may
+                 * need a lookahead, can be translated in bulk. */
+                const char *eof = memchr(bufstart, 0x1a, num_read);
+                DWORD end = eof ? eof - bufstart : num_read - 1;
+                char *cr;
+
+                while (i < end && (cr = memchr(bufstart + i, '\r', end - i)))
+                {
+                    DWORD len = cr - (bufstart + i);
+
+                    memmove(bufstart + j, bufstart + i, len);
+                    i += len + 1;
+                    j += len;
+                    /* in text mode, strip \r if followed by \n */
+                    if (bufstart[i] != '\n')
+                        bufstart[j++] = '\r';
+                }
+                memmove(bufstart + j, bufstart + i, end - i);
+                j += end - i;
+                i = end;
+            }
+
+            for (; i<num_read; i+=1+utf16)
             {
                 /* in text mode, a ctrl-z signals EOF */
                 if (bufstart[i]==0x1a && (!utf16 || bufstart[i+1]==0))
@@ -3774,19 +3799,37 @@ char * CDECL fgets(char *s, int size, FILE* file)
 
   _lock_file(file);
 
-  while ((size >1) && (cc = _fgetc_nolock(file)) != EOF && cc != '\n')
+  while (size > 1)
+  {
+    /* copy whole runs out of the stream buffer */
+    if (file->_cnt > 0)
     {
-      *s++ = (char)cc;
-      size --;
+      int len = min(file->_cnt, size - 1);
+      char *nl = memchr(file->_ptr, '\n', len);
+
+      if (nl) len = nl - file->_ptr + 1;
+      memcpy(s, file->_ptr, len);
+      file->_ptr += len;
+      file->_cnt -= len;
+      s += len;
+      size -= len;
+      cc = (unsigned char)s[-1];
+      if (nl) break;
+      continue;
     }
+
+    if ((cc = _filbuf(file)) == EOF)
+      break;
+    *s++ = cc;
+    size--;
+    if (cc == '\n') break;
+  }
   if ((cc == EOF) && (s == buf_start)) /* If nothing read, return 0*/
   {
     TRACE(":nothing read\n");
     _unlock_file(file);
     return NULL;
   }
-  if ((cc != EOF) && (size > 1))
-    *s++ = cc;
   *s = '\0';
   TRACE(":got %s\n", debugstr_a(buf_start));
   _unlock_file(file);
@@ -256,8 +256,19 @@ void CDECL _chkesp(void)
 
 static inline void swap(char *l, char *r, size_t size)
 {
+    size_t word;
     char tmp;
 
+    /* elements are usually pointers or structures, swap them word by word */
+    while(size >= sizeof(word)) {
+        memcpy(&word, l, sizeof(word));
+        memcpy(l, r, sizeof(word));
+        memcpy(r, &word, sizeof(word));
+        l += sizeof(word);
+        r += sizeof(word);
+        size -= sizeof(word);
+    }
+
     while(size--) {
         tmp = *l;
         *l++ = *r;
@@ -390,4 +390,22 @@ extern char* __cdecl __unDName(char *,const char*,int,malloc_func_t,free_func_t,
 
 #define INHERIT_THREAD_PRIORITY 0xF000
 
+/* The string functions scan aligned words at a time. Aligned words never
+ * cross a page boundary, so whole words can be read even if the string ends
+ * in the middle of one. */
+#define WORD_ONES        ((size_t)-1 / 0xff)
+#define WORD_HIGHS       (WORD_ONES * 0x80)
+#define WCHAR_WORD_ONES  ((size_t)-1 / 0xffff)
+#define WCHAR_WORD_HIGHS (WCHAR_WORD_ONES * 0x8000)
+
+static inline BOOL word_has_zero_byte(size_t w)
+{
+    return ((w - WORD_ONES) & ~w & WORD_HIGHS) != 0;
+}
+
+static inline BOOL word_has_zero_wchar(size_t w)
+{
+    return ((w - WCHAR_WORD_ONES) & ~w & WCHAR_WORD_HIGHS) != 0;
+}
+
 #endif /* __WINE_MSVCRT_H */
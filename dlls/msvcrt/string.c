@@ -742,6 +742,47 @@ static inline BOOL bnum_to_mant(struct bnum *b, ULONGLONG *m)
     return TRUE;
 }
 
+/* Decimal values with at most 53 significant bits scaled by an exactly
+ * representable power of ten are converted by a single correctly rounded
+ * multiplication or division. */
+static BOOL fpnum_parse_fast(struct bnum *b, int e10, ULONGLONG *m, int *e2)
+{
+    static const double p10[] =
+    {
+        1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+        1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+    };
+    ULONGLONG bits, v;
+    double d;
+
+    if(e10 <= -(int)ARRAY_SIZE(p10) || e10 >= (int)ARRAY_SIZE(p10))
+        return FALSE;
+
+    v = b->data[bnum_idx(b, b->e-1)];
+    if(b->e-b->b == 2)
+        v = v*LIMB_MAX + b->data[bnum_idx(b, b->b)];
+    if(v > (ULONGLONG)1 << MANT_BITS)
+        return FALSE;
+
+    /* The result is only correctly rounded in round to nearest mode and,
+     * on x87, with double precision. */
+#ifdef __i386__
+    if((_control87(0, 0) & (_MCW_RC | _MCW_PC)) != (_RC_NEAR | _PC_53))
+        return FALSE;
+#else
+    if((_control87(0, 0) & _MCW_RC) != _RC_NEAR)
+        return FALSE;
+#endif
+
+    d = e10 < 0 ? (double)v / p10[-e10] : (double)v * p10[e10];
+
+    /* return the normal double as mantissa and binary exponent */
+    bits = *(ULONGLONG*)&d;
+    *m = (bits & (((ULONGLONG)1 << (MANT_BITS - 1)) - 1)) | (ULONGLONG)1 << (MANT_BITS - 1);
+    *e2 = (bits >> (MANT_BITS - 1)) - ((1 << (EXP_BITS - 1)) - 1) - (MANT_BITS - 1);
+    return TRUE;
+}
+
 static struct fpnum fpnum_parse_bnum(wchar_t (*get)(void *ctx), void (*unget)(void *ctx),
         void *ctx, pthreadlocinfo locinfo, BOOL ldouble, struct bnum *b)
 {
@@ -929,6 +970,8 @@ static struct fpnum fpnum_parse_bnum(wchar_t (*get)(void *ctx), void (*unget)(vo
     /* move decimal point to limb boundary */
     if(limb_digits==dp && b->b==b->e-1)
         return fpnum(sign, 0, b->data[bnum_idx(b, b->e-1)], FP_ROUND_ZERO);
+    if(!ldouble && b->e-b->b <= 2 && fpnum_parse_fast(b, dp-limb_digits-(b->e-b->b-1)*LIMB_DIGITS, &m, &e2))
+        return fpnum(sign, e2, m, FP_ROUND_ZERO);
     off = (dp - limb_digits) % LIMB_DIGITS;
     if(off < 0) off += LIMB_DIGITS;
     if(off) bnum_mult(b, p10s[off]);
@@ -1513,7 +1556,12 @@ int CDECL _atoldbl(_LDOUBLE *value, char *str)
 size_t __cdecl strlen(const char *str)
 {
     const char *s = str;
-    while (*s) s++;
+    const size_t *w;
+
+    for (; (size_t)s % sizeof(size_t); s++)
+        if (!*s) return s - str;
+    for (w = (const size_t *)s; !word_has_zero_byte(*w); w++);
+    for (s = (const char *)w; *s; s++);
     return s - str;
 }
 
@@ -2680,9 +2728,14 @@ int CDECL I10_OUTPUT(MSVCRT__LDOUBLE ld80, int prec, int flag, struct _I10_OUTPU
  */
 int __cdecl memcmp(const void *ptr1, const void *ptr2, size_t n)
 {
+    typedef size_t DECLSPEC_ALIGN(1) unaligned_size_t;
     const unsigned char *p1, *p2;
 
-    for (p1 = ptr1, p2 = ptr2; n; n--, p1++, p2++)
+    /* skip the equal prefix a word at a time */
+    for (p1 = ptr1, p2 = ptr2; n >= sizeof(size_t); n -= sizeof(size_t), p1 += sizeof(size_t), p2 += sizeof(size_t))
+        if (*(const unaligned_size_t *)p1 != *(const unaligned_size_t *)p2) break;
+
+    for (; n; n--, p1++, p2++)
     {
         if (*p1 < *p2) return -1;
         if (*p1 > *p2) return 1;
@@ -3150,11 +3203,20 @@ void *__cdecl memset(void *dst, int c, size_t n)
  */
 char* __cdecl strchr(const char *str, int c)
 {
-    do
+    size_t mask = WORD_ONES * (unsigned char)c;
+    const size_t *w;
+
+    for (; (size_t)str % sizeof(size_t); str++)
     {
         if (*str == (char)c) return (char*)str;
-    } while (*str++);
-    return NULL;
+        if (!*str) return NULL;
+    }
+    for (w = (const size_t *)str; !word_has_zero_byte(*w) && !word_has_zero_byte(*w ^ mask); w++);
+    for (str = (const char *)w;; str++)
+    {
+        if (*str == (char)c) return (char*)str;
+        if (!*str) return NULL;
+    }
 }
 
 /*********************************************************************
@@ -3172,9 +3234,15 @@ char* __cdecl strrchr(const char *str, int c)
  */
 void* __cdecl memchr(const void *ptr, int c, size_t n)
 {
+    size_t mask = WORD_ONES * (unsigned char)c;
     const unsigned char *p = ptr;
 
-    for (p = ptr; n; n--, p++) if (*p == (unsigned char)c) return (void *)(ULONG_PTR)p;
+    for (; n && (size_t)p % sizeof(size_t); n--, p++)
+        if (*p == (unsigned char)c) return (void *)(ULONG_PTR)p;
+    for (; n >= sizeof(size_t); n -= sizeof(size_t), p += sizeof(size_t))
+        if (word_has_zero_byte(*(const size_t *)p ^ mask)) break;
+    for (; n; n--, p++)
+        if (*p == (unsigned char)c) return (void *)(ULONG_PTR)p;
     return NULL;
 }
 
@@ -4477,6 +4477,81 @@ static void test_wcsncpy(void)
             wine_dbgstr_wn(dst, ARRAY_SIZE(dst)));
 }
 
+static void test_word_boundaries(void)
+{
+    char buf[80], buf2[80];
+    wchar_t wbuf[80], wbuf2[81];
+    unsigned int off, len, i;
+    const wchar_t *wexp;
+    const char *exp;
+    wchar_t *wp, *uwp;
+    size_t ret;
+    char *p;
+    int r;
+
+    for (off = 0; off < 16; off++)
+    {
+        for (len = 0; len < 40; len++)
+        {
+            for (i = 0; i < sizeof(buf); i++)
+                buf[i] = i % 7 ? 0x80 | i : 'a';
+            buf[off + len] = 0;
+
+            ret = strlen(buf + off);
+            ok(ret == len, "%u/%u: strlen returned %Iu.\n", off, len, ret);
+
+            for (exp = buf + off; *exp && *exp != 'a'; exp++);
+            if (!*exp) exp = NULL;
+            p = strchr(buf + off, 'a');
+            ok(p == exp, "%u/%u: strchr returned %p, expected %p.\n", off, len, p, exp);
+            p = strchr(buf + off, 0);
+            ok(p == buf + off + len, "%u/%u: strchr returned %p.\n", off, len, p);
+
+            buf[off + len] = 'b';
+            p = memchr(buf + off, 'b', len);
+            ok(!p, "%u/%u: memchr returned %p.\n", off, len, p);
+            p = memchr(buf + off, 'b', len + 1);
+            ok(p == buf + off + len, "%u/%u: memchr returned %p.\n", off, len, p);
+
+            memcpy(buf2 + 1, buf + off, len + 1);
+            r = memcmp(buf + off, buf2 + 1, len + 1);
+            ok(!r, "%u/%u: memcmp returned %d.\n", off, len, r);
+            buf2[1 + len] = 'c';
+            r = memcmp(buf + off, buf2 + 1, len + 1);
+            ok(r < 0, "%u/%u: memcmp returned %d.\n", off, len, r);
+            r = memcmp(buf + off, buf2 + 1, len);
+            ok(!r, "%u/%u: memcmp returned %d.\n", off, len, r);
+
+            for (i = 0; i < ARRAY_SIZE(wbuf); i++)
+                wbuf[i] = i % 7 ? 0x8000 | (i << 8) | i : 'a';
+            wbuf[off + len] = 0;
+
+            ret = wcslen(wbuf + off);
+            ok(ret == len, "%u/%u: wcslen returned %Iu.\n", off, len, ret);
+
+            for (wexp = wbuf + off; *wexp && *wexp != 'a'; wexp++);
+            if (!*wexp) wexp = NULL;
+            wp = wcschr(wbuf + off, 'a');
+            ok(wp == wexp, "%u/%u: wcschr returned %p, expected %p.\n", off, len, wp, wexp);
+            wp = wcschr(wbuf + off, 0);
+            ok(wp == wbuf + off + len, "%u/%u: wcschr returned %p.\n", off, len, wp);
+            wp = wcschr(wbuf + off, 0x8000 | ((off + len) << 8) | (off + len));
+            ok(!wp, "%u/%u: wcschr returned %p.\n", off, len, wp);
+
+            /* not even aligned to a wchar_t */
+            uwp = (wchar_t *)((char *)wbuf2 + 1);
+            memcpy(uwp, wbuf + off, (len + 1) * sizeof(wchar_t));
+            ret = wcslen(uwp);
+            ok(ret == len, "%u/%u: unaligned wcslen returned %Iu.\n", off, len, ret);
+            wp = wcschr(uwp, 'a');
+            ok(wp == (wexp ? uwp + (wexp - (wbuf + off)) : NULL),
+                    "%u/%u: unaligned wcschr returned %p, expected %p.\n", off, len, wp, wexp);
+            wp = wcschr(uwp, 0);
+            ok(wp == uwp + len, "%u/%u: unaligned wcschr returned %p.\n", off, len, wp);
+        }
+    }
+}
+
 START_TEST(string)
 {
     char mem[100];
@@ -4633,4 +4708,5 @@ START_TEST(string)
     test_SpecialCasing();
     test__mbbtype();
     test_wcsncpy();
+    test_word_boundaries();
 }
@@ -2857,8 +2857,27 @@ wint_t CDECL towupper(wint_t c)
  */
 wchar_t* CDECL wcschr(const wchar_t *str, wchar_t ch)
 {
-    do { if (*str == ch) return (WCHAR *)(ULONG_PTR)str; } while (*str++);
-    return NULL;
+    size_t mask = WCHAR_WORD_ONES * ch;
+    const size_t *w;
+
+    /* strings that aren't even aligned to a wchar_t use the plain loop */
+    if ((size_t)str % sizeof(wchar_t))
+    {
+        do { if (*str == ch) return (WCHAR *)(ULONG_PTR)str; } while (*str++);
+        return NULL;
+    }
+
+    for (; (size_t)str % sizeof(size_t); str++)
+    {
+        if (*str == ch) return (WCHAR *)(ULONG_PTR)str;
+        if (!*str) return NULL;
+    }
+    for (w = (const size_t *)str; !word_has_zero_wchar(*w) && !word_has_zero_wchar(*w ^ mask); w++);
+    for (str = (const wchar_t *)w;; str++)
+    {
+        if (*str == ch) return (WCHAR *)(ULONG_PTR)str;
+        if (!*str) return NULL;
+    }
 }
 
 /*********************************************************************
@@ -2877,7 +2896,18 @@ wchar_t* CDECL wcsrchr(const wchar_t *str, wchar_t ch)
 size_t CDECL wcslen(const wchar_t *str)
 {
     const wchar_t *s = str;
-    while (*s) s++;
+    const size_t *w;
+
+    if ((size_t)s % sizeof(wchar_t))
+    {
+        while (*s) s++;
+        return s - str;
+    }
+
+    for (; (size_t)s % sizeof(size_t); s++)
+        if (!*s) return s - str;
+    for (w = (const size_t *)s; !word_has_zero_wchar(*w); w++);
+    for (s = (const wchar_t *)w; *s; s++);
     return s - str;
 }
 
@@ -375,7 +375,7 @@ NTSTATUS WINAPI RtlpUnWaitCriticalSection( RTL_CRITICAL_SECTION *crit )
 
 static inline void small_pause(void)
 {
-#ifdef __i386__
+#if defined(__i386__) || defined(__x86_64__)
     __asm__ __volatile__( "rep;nop" : : : "memory" );
 #else
     __asm__ __volatile__( "" : : : "memory" );
@@ -522,6 +522,16 @@ struct srw_lock
 };
 C_ASSERT( sizeof(struct srw_lock) == 4 );
 
+/* Number of times to poll a contended SRW lock before going to sleep on it.
+ * Most SRW locks protect very short sections, so on a multiprocessor machine
+ * the owner will usually release the lock before a wait could even start. */
+#define SRW_SPIN_COUNT 1024
+
+static inline unsigned int srw_spin_count(void)
+{
+    return NtCurrentTeb()->Peb->NumberOfProcessors > 1 ? SRW_SPIN_COUNT : 0;
+}
+
 /***********************************************************************
  *              RtlInitializeSRWLock (NTDLL.@)
  *
@@ -548,6 +558,14 @@ void WINAPI RtlInitializeSRWLock( RTL_SRWLOCK *lock )
 void WINAPI RtlAcquireSRWLockExclusive( RTL_SRWLOCK *lock )
 {
     union { RTL_SRWLOCK *rtl; struct srw_lock *s; LONG *l; } u = { lock };
+    unsigned int count;
+
+    for (count = srw_spin_count(); count > 0; count--)
+    {
+        if (u.s->exclusive_waiters) break;  /* somebody is already queued, don't bother spinning */
+        if (!u.s->owners && RtlTryAcquireSRWLockExclusive( lock )) return;
+        YieldProcessor();
+    }
 
     InterlockedIncrement16( &u.s->exclusive_waiters );
 
@@ -575,6 +593,7 @@ void WINAPI RtlAcquireSRWLockExclusive( RTL_SRWLOCK *lock )
         } while (InterlockedCompareExchange( u.l, new.l, old.l ) != old.l);
 
         if (!wait) return;
+        TRACE( "lock %p contended, caller %p\n", lock, __builtin_return_address(0) );
         RtlWaitOnAddress( &u.s->owners, &new.s.owners, sizeof(short), NULL );
     }
 }
@@ -589,6 +608,14 @@ void WINAPI RtlAcquireSRWLockExclusive( RTL_SRWLOCK *lock )
 void WINAPI RtlAcquireSRWLockShared( RTL_SRWLOCK *lock )
 {
     union { RTL_SRWLOCK *rtl; struct srw_lock *s; LONG *l; } u = { lock };
+    unsigned int count;
+
+    for (count = srw_spin_count(); count > 0; count--)
+    {
+        if (u.s->exclusive_waiters) break;  /* we would have to wait for them anyway */
+        if (u.s->owners != -1 && RtlTryAcquireSRWLockShared( lock )) return;
+        YieldProcessor();
+    }
 
     for (;;)
     {
@@ -614,6 +641,7 @@ void WINAPI RtlAcquireSRWLockShared( RTL_SRWLOCK *lock )
         } while (InterlockedCompareExchange( u.l, new.l, old.l ) != old.l);
 
         if (!wait) return;
+        TRACE( "lock %p contended, caller %p\n", lock, __builtin_return_address(0) );
         RtlWaitOnAddress( u.s, &new.s, sizeof(struct srw_lock), NULL );
     }
 }
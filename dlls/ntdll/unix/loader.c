@@ -647,83 +647,109 @@ static void init_paths( char *argv[] )
 }
 
 
-static void preloader_exec( char **argv )
+static char *get_preloader_path( const char *loader )
 {
-    if (use_preloader)
-    {
-        static const char *preloader = "wine-preloader";
-        char *p;
+    static const char *preloader = "wine-preloader";
+    const char *p;
+    char *ret;
 
-        if (!(p = strrchr( argv[1], '/' ))) p = argv[1];
-        else p++;
+    if (!use_preloader) return NULL;
 
-        if (strlen(p) > 2 && !strcmp( p + strlen(p) - 2, "64" )) preloader = "wine64-preloader";
-        argv[0] = malloc( p - argv[1] + strlen(preloader) + 1 );
-        memcpy( argv[0], argv[1], p - argv[1] );
-        strcpy( argv[0] + (p - argv[1]), preloader );
+    if (!(p = strrchr( loader, '/' ))) p = loader;
+    else p++;
 
-#ifdef __APPLE__
-        {
-            posix_spawnattr_t attr;
-            posix_spawnattr_init( &attr );
-            posix_spawnattr_setflags( &attr, POSIX_SPAWN_SETEXEC | _POSIX_SPAWN_DISABLE_ASLR );
-            posix_spawn( NULL, argv[0], NULL, &attr, argv, *_NSGetEnviron() );
-            posix_spawnattr_destroy( &attr );
-        }
-#endif
-        execv( argv[0], argv );
-        free( argv[0] );
-    }
-    execv( argv[1], argv + 1 );
+    if (strlen(p) > 2 && !strcmp( p + strlen(p) - 2, "64" )) preloader = "wine64-preloader";
+    ret = malloc( p - loader + strlen(preloader) + 1 );
+    memcpy( ret, loader, p - loader );
+    strcpy( ret + (p - loader), preloader );
+    return ret;
 }
 
-static NTSTATUS loader_exec( const char *loader, char **argv, WORD machine )
+static void add_loader_path( char **paths, unsigned int *count, char *loader )
 {
-    char *p, *path;
+    paths[(*count)++] = get_preloader_path( loader );
+    paths[(*count)++] = loader;
+}
+
+/* build the list of preloader and loader pairs to try, terminated by a NULL loader */
+static char **get_loader_paths( const char *loader, WORD machine )
+{
+    unsigned int count = 0, max = 4;
+    char *p, *path, **paths;
+
+    if ((path = getenv( "PATH" ))) for (p = path, max++; *p; p++) if (*p == ':') max++;
+    if (!(paths = malloc( 2 * max * sizeof(*paths) ))) return NULL;
 
     if (build_dir)
     {
-        argv[1] = build_path( build_dir, (machine == IMAGE_FILE_MACHINE_AMD64) ? "loader/wine64" : "loader/wine" );
-        preloader_exec( argv );
-        return STATUS_INVALID_IMAGE_FORMAT;
+        add_loader_path( paths, &count, build_path( build_dir, (machine == IMAGE_FILE_MACHINE_AMD64) ?
+                                                     "loader/wine64" : "loader/wine" ));
+        paths[count + 1] = NULL;
+        return paths;
     }
 
     if ((p = strrchr( loader, '/' ))) loader = p + 1;
 
-    argv[1] = build_path( bin_dir, loader );
-    preloader_exec( argv );
+    add_loader_path( paths, &count, build_path( bin_dir, loader ));
+    if ((p = getenv( "WINELOADER" ))) add_loader_path( paths, &count, p );
 
-    argv[1] = getenv( "WINELOADER" );
-    if (argv[1]) preloader_exec( argv );
-
-    if ((path = getenv( "PATH" )))
+    if (path)
     {
         for (p = strtok( strdup( path ), ":" ); p; p = strtok( NULL, ":" ))
+            add_loader_path( paths, &count, build_path( p, loader ));
+    }
+
+    add_loader_path( paths, &count, build_path( BINDIR, loader ));
+    paths[count + 1] = NULL;
+    return paths;
+}
+
+/* only calls execv(), so that it's safe to use in a vfork() child */
+static void exec_loader_paths( char **argv, char **paths )
+{
+    for ( ; paths[1]; paths += 2)
+    {
+        argv[1] = paths[1];
+        if ((argv[0] = paths[0]))
         {
-            argv[1] = build_path( p, loader );
-            preloader_exec( argv );
+#ifdef __APPLE__
+            posix_spawnattr_t attr;
+            posix_spawnattr_init( &attr );
+            posix_spawnattr_setflags( &attr, POSIX_SPAWN_SETEXEC | _POSIX_SPAWN_DISABLE_ASLR );
+            posix_spawn( NULL, argv[0], NULL, &attr, argv, *_NSGetEnviron() );
+            posix_spawnattr_destroy( &attr );
+#endif
+            execv( argv[0], argv );
         }
+        execv( argv[1], argv + 1 );
     }
+}
+
+static NTSTATUS loader_exec( const char *loader, char **argv, WORD machine )
+{
+    char **paths = get_loader_paths( loader, machine );
 
-    argv[1] = build_path( BINDIR, loader );
-    preloader_exec( argv );
+    if (!paths) return STATUS_NO_MEMORY;
+    exec_loader_paths( argv, paths );
     return STATUS_INVALID_IMAGE_FORMAT;
 }
 
 
 /***********************************************************************
- *           exec_wineloader
+ *           prepare_wineloader
  *
- * argv[0] and argv[1] must be reserved for the preloader and loader respectively.
+ * Set up the environment for exec_wineloader() and return the loader paths
+ * to pass to it. This allocates memory and modifies the environment, so it
+ * has to be called before vfork().
  */
-NTSTATUS exec_wineloader( char **argv, int socketfd, const pe_image_info_t *pe_info )
+char **prepare_wineloader( int socketfd, const pe_image_info_t *pe_info )
 {
     WORD machine = pe_info->machine;
     ULONGLONG res_start = pe_info->base;
     ULONGLONG res_end = pe_info->base + pe_info->map_size;
     const char *loader = argv0;
     const char *loader_env = getenv( "WINELOADER" );
-    char preloader_reserve[64], socket_env[64];
+    char *preloader_reserve, *socket_env;
     BOOL is_child_64bit;
 
     if (pe_info->image_flags & IMAGE_FLAGS_WineFakeDll) res_start = res_end = 0;
@@ -739,7 +765,7 @@ NTSTATUS exec_wineloader( char **argv, int socketfd, const pe_image_info_t *pe_i
             int len = strlen( loader_env );
             char *env = malloc( sizeof("WINELOADER=") + len + 2 );
 
-            if (!env) return STATUS_NO_MEMORY;
+            if (!env) return NULL;
             strcpy( env, "WINELOADER=" );
             strcat( env, loader_env );
             if (is_child_64bit)
@@ -759,6 +785,7 @@ NTSTATUS exec_wineloader( char **argv, int socketfd, const pe_image_info_t *pe_i
 
     signal( SIGPIPE, SIG_DFL );
 
+    if (!(socket_env = malloc( 64 )) || !(preloader_reserve = malloc( 64 ))) return NULL;
     sprintf( socket_env, "WINESERVERSOCKET=%u", socketfd );
     sprintf( preloader_reserve, "WINEPRELOADRESERVE=%x%08x-%x%08x",
              (ULONG)(res_start >> 32), (ULONG)res_start, (ULONG)(res_end >> 32), (ULONG)res_end );
@@ -766,7 +793,20 @@ NTSTATUS exec_wineloader( char **argv, int socketfd, const pe_image_info_t *pe_i
     putenv( preloader_reserve );
     putenv( socket_env );
 
-    return loader_exec( loader, argv, machine );
+    return get_loader_paths( loader, machine );
+}
+
+
+/***********************************************************************
+ *           exec_wineloader
+ *
+ * Exec the loader with the paths returned by prepare_wineloader().
+ * argv[0] and argv[1] must be reserved for the preloader and loader respectively.
+ */
+NTSTATUS exec_wineloader( char **argv, char **paths )
+{
+    exec_loader_paths( argv, paths );
+    return STATUS_INVALID_IMAGE_FORMAT;
 }
 
 
@@ -420,6 +420,13 @@ static BOOL is_unix_console_handle( HANDLE handle )
 }
 
 
+/* The intermediate child only exits once the grandchild has exec'ed, so the
+ * grandchild can share its memory with vfork() instead of copying the whole
+ * address space again. vfork() is deprecated on macOS. */
+#ifdef __APPLE__
+#define vfork fork
+#endif
+
 /***********************************************************************
  *           spawn_process
  */
@@ -441,7 +448,15 @@ static NTSTATUS spawn_process( const RTL_USER_PROCESS_PARAMETERS *params, int so
 
     if (!(pid = fork()))  /* child */
     {
-        if (!(pid = fork()))  /* grandchild */
+        char **loader_paths;
+
+        /* the grandchild shares our memory, so everything that allocates
+         * memory or modifies the environment has to be done before vfork() */
+        if (winedebug) putenv( winedebug );
+        argv = build_argv( &params->CommandLine, 2 );
+        if (!argv || !(loader_paths = prepare_wineloader( socketfd, pe_info ))) _exit(1);
+
+        if (!(pid = vfork()))  /* grandchild */
         {
             if (params->ConsoleFlags ||
                 params->ConsoleHandle == CONSOLE_HANDLE_ALLOC ||
@@ -455,15 +470,13 @@ static NTSTATUS spawn_process( const RTL_USER_PROCESS_PARAMETERS *params, int so
             if (stdin_fd != -1 && stdin_fd != 0) close( stdin_fd );
             if (stdout_fd != -1 && stdout_fd != 1) close( stdout_fd );
 
-            if (winedebug) putenv( winedebug );
             if (unixdir != -1)
             {
                 fchdir( unixdir );
                 close( unixdir );
             }
-            argv = build_argv( &params->CommandLine, 2 );
 
-            exec_wineloader( argv, socketfd, pe_info );
+            exec_wineloader( argv, loader_paths );
             _exit(1);
         }
 
@@ -579,10 +592,15 @@ static NTSTATUS fork_and_exec( OBJECT_ATTRIBUTES *attr, int unixdir,
 
     if (!(pid = fork()))  /* child */
     {
-        if (!(pid = fork()))  /* grandchild */
-        {
-            close( fd[0] );
+        /* see spawn_process() */
+        close( fd[0] );
+        /* Reset signals that we previously set to SIG_IGN */
+        signal( SIGPIPE, SIG_DFL );
+        argv = build_argv( &params->CommandLine, 0 );
+        envp = build_envp( params->Environment );
 
+        if (!(pid = vfork()))  /* grandchild */
+        {
             if (params->ConsoleFlags ||
                 params->ConsoleHandle == CONSOLE_HANDLE_ALLOC ||
                 (params->hStdInput == INVALID_HANDLE_VALUE && params->hStdOutput == INVALID_HANDLE_VALUE))
@@ -595,11 +613,6 @@ static NTSTATUS fork_and_exec( OBJECT_ATTRIBUTES *attr, int unixdir,
             if (stdin_fd != -1 && stdin_fd != 0) close( stdin_fd );
             if (stdout_fd != -1 && stdout_fd != 1) close( stdout_fd );
 
-            /* Reset signals that we previously set to SIG_IGN */
-            signal( SIGPIPE, SIG_DFL );
-
-            argv = build_argv( &params->CommandLine, 0 );
-            envp = build_envp( params->Environment );
             if (unixdir != -1)
             {
                 fchdir( unixdir );
@@ -121,6 +121,7 @@ struct file_view
 #define VPROT_WRITEWATCH 0x40
 /* per-mapping protection flags */
 #define VPROT_SYSTEM     0x0200  /* system view (underlying mmap not under our control) */
+#define VPROT_FREE_STACK 0x0400  /* stack of an exited thread, kept for reuse */
 
 /* Conversion from VPROT_* to Win32 flags */
 static const BYTE VIRTUAL_Win32Flags[16] =
@@ -181,6 +182,17 @@ static void **next_free_teb;
 static int teb_block_pos;
 static struct list teb_list = LIST_INIT( teb_list );
 
+/* stacks of exited threads, kept around for reuse by new threads */
+struct cached_stack
+{
+    void  *base;        /* base of the stack view */
+    SIZE_T size;        /* size of the stack view */
+    SIZE_T extra_size;  /* size of the view following it (kernel stack) */
+};
+#define MAX_CACHED_STACKS 16
+static struct cached_stack stack_cache[MAX_CACHED_STACKS];
+static unsigned int stack_cache_count;
+
 #define ROUND_ADDR(addr,mask) ((void *)((UINT_PTR)(addr) & ~(UINT_PTR)(mask)))
 #define ROUND_SIZE(addr,size) (((SIZE_T)(size) + ((UINT_PTR)(addr) & page_mask) + page_mask) & ~page_mask)
 
@@ -3006,6 +3018,97 @@ NTSTATUS virtual_alloc_teb( TEB **ret_teb )
 }
 
 
+/***********************************************************************
+ *           cache_thread_stack
+ *
+ * Keep the native stack of an exited thread for reuse by the next thread.
+ */
+static BOOL cache_thread_stack( void *base, void *kernel_stack )
+{
+    struct file_view *view, *extra_view;
+    sigset_t sigset;
+    BOOL ret = FALSE;
+
+    server_enter_uninterrupted_section( &virtual_mutex, &sigset );
+    if (stack_cache_count < MAX_CACHED_STACKS &&
+        (view = find_view( base, 0 )) && view->base == base &&
+        (char *)view->base + view->size == kernel_stack &&
+        (extra_view = find_view( kernel_stack, 0 )) && extra_view->base == kernel_stack &&
+        !decommit_pages( view, 0, 0 ) && !decommit_pages( extra_view, 0, 0 ))
+    {
+        /* the pages are released until the stack is reused; the flag makes
+         * NtFreeVirtualMemory() refuse to free the views in the meantime */
+        view->protect |= VPROT_FREE_STACK;
+        extra_view->protect |= VPROT_FREE_STACK;
+        stack_cache[stack_cache_count].base = base;
+        stack_cache[stack_cache_count].size = view->size;
+        stack_cache[stack_cache_count].extra_size = extra_view->size;
+        stack_cache_count++;
+        ret = TRUE;
+    }
+    server_leave_uninterrupted_section( &virtual_mutex, &sigset );
+    return ret;
+}
+
+
+/***********************************************************************
+ *           release_cached_stack
+ *
+ * Free the views of a cached stack that can't be reused. virtual_mutex must be held.
+ */
+static void release_cached_stack( char *base, SIZE_T size )
+{
+    char *extra_base = base + size;
+    struct file_view *view;
+
+    if ((view = find_view( base, 0 )) && view->base == base && (view->protect & VPROT_FREE_STACK))
+        delete_view( view );
+    if ((view = find_view( extra_base, 0 )) && view->base == extra_base && (view->protect & VPROT_FREE_STACK))
+        delete_view( view );
+}
+
+
+/***********************************************************************
+ *           get_cached_stack
+ *
+ * Retrieve a cached stack of the requested size and commit it again.
+ * virtual_mutex must be held.
+ */
+static struct file_view *get_cached_stack( SIZE_T size, SIZE_T extra_size, ULONG_PTR zero_bits )
+{
+    struct file_view *view, *extra_view;
+    unsigned int i = stack_cache_count;
+
+    if (zero_bits) return NULL;  /* not worth checking the address constraints */
+
+    while (i--)
+    {
+        char *base = stack_cache[i].base;
+
+        if (stack_cache[i].size != size || stack_cache[i].extra_size != extra_size) continue;
+        stack_cache[i] = stack_cache[--stack_cache_count];
+
+        if (!(view = find_view( base, 0 )) || view->base != base || view->size != size ||
+            !(view->protect & VPROT_FREE_STACK) ||
+            !(extra_view = find_view( base + size, 0 )) || extra_view->base != base + size ||
+            extra_view->size != extra_size || !(extra_view->protect & VPROT_FREE_STACK))
+        {
+            release_cached_stack( base, size );
+            continue;
+        }
+
+        view->protect &= ~VPROT_FREE_STACK;
+        extra_view->protect &= ~VPROT_FREE_STACK;
+        set_page_vprot( view->base, view->size, VPROT_READ | VPROT_WRITE | VPROT_COMMITTED );
+        mprotect_range( view->base, view->size, 0, 0 );
+        set_page_vprot( extra_view->base, extra_view->size, VPROT_READ | VPROT_WRITE | VPROT_COMMITTED );
+        mprotect_range( extra_view->base, extra_view->size, 0, 0 );
+        return view;
+    }
+    return NULL;
+}
+
+
 /***********************************************************************
  *           virtual_free_teb
  */
@@ -3018,6 +3121,12 @@ void virtual_free_teb( TEB *teb )
     WOW_TEB *wow_teb = get_wow_teb( teb );
 
     signal_free_thread( teb );
+    if (!wow_teb && teb->DeallocationStack && thread_data->kernel_stack &&
+        cache_thread_stack( teb->DeallocationStack, thread_data->kernel_stack ))
+    {
+        teb->DeallocationStack = NULL;
+        thread_data->kernel_stack = NULL;
+    }
     if (teb->DeallocationStack)
     {
         size = 0;
@@ -3100,7 +3209,7 @@ NTSTATUS virtual_alloc_thread_stack( INITIAL_TEB *stack, ULONG_PTR zero_bits, SI
                                      SIZE_T commit_size, SIZE_T extra_size )
 {
     struct file_view *view;
-    NTSTATUS status;
+    NTSTATUS status = STATUS_SUCCESS;
     sigset_t sigset;
     SIZE_T size;
 
@@ -3113,14 +3222,34 @@ NTSTATUS virtual_alloc_thread_stack( INITIAL_TEB *stack, ULONG_PTR zero_bits, SI
 
     server_enter_uninterrupted_section( &virtual_mutex, &sigset );
 
-    if ((status = map_view( &view, NULL, size + extra_size, FALSE,
-                            VPROT_READ | VPROT_WRITE | VPROT_COMMITTED, zero_bits )) != STATUS_SUCCESS)
-        goto done;
+    if (!(view = get_cached_stack( size, extra_size, zero_bits )))
+    {
+        if ((status = map_view( &view, NULL, size + extra_size, FALSE,
+                                VPROT_READ | VPROT_WRITE | VPROT_COMMITTED, zero_bits )) != STATUS_SUCCESS)
+            goto done;
 
 #ifdef VALGRIND_STACK_REGISTER
-    VALGRIND_STACK_REGISTER( view->base, (char *)view->base + view->size );
+        VALGRIND_STACK_REGISTER( view->base, (char *)view->base + view->size );
 #endif
 
+        if (extra_size)
+        {
+            struct file_view *extra_view;
+
+            /* shrink the first view and create a second one for the extra size */
+            /* this allows the app to free the stack without freeing the thread start portion */
+            view->size -= extra_size;
+            status = create_view( &extra_view, (char *)view->base + view->size, extra_size,
+                                  VPROT_READ | VPROT_WRITE | VPROT_COMMITTED );
+            if (status != STATUS_SUCCESS)
+            {
+                view->size += extra_size;
+                delete_view( view );
+                goto done;
+            }
+        }
+    }
+
     /* setup no access guard page */
     set_page_vprot( view->base, page_size, VPROT_COMMITTED );
     set_page_vprot( (char *)view->base + page_size, page_size,
@@ -3128,23 +3257,6 @@ NTSTATUS virtual_alloc_thread_stack( INITIAL_TEB *stack, ULONG_PTR zero_bits, SI
     mprotect_range( view->base, 2 * page_size, 0, 0 );
     VIRTUAL_DEBUG_DUMP_VIEW( view );
 
-    if (extra_size)
-    {
-        struct file_view *extra_view;
-
-        /* shrink the first view and create a second one for the extra size */
-        /* this allows the app to free the stack without freeing the thread start portion */
-        view->size -= extra_size;
-        status = create_view( &extra_view, (char *)view->base + view->size, extra_size,
-                              VPROT_READ | VPROT_WRITE | VPROT_COMMITTED );
-        if (status != STATUS_SUCCESS)
-        {
-            view->size += extra_size;
-            delete_view( view );
-            goto done;
-        }
-    }
-
     /* note: limit is lower than base since the stack grows down */
     stack->OldStackBase = 0;
     stack->OldStackLimit = 0;
@@ -3921,7 +4033,8 @@ NTSTATUS WINAPI NtFreeVirtualMemory( HANDLE process, PVOID *addr_ptr, SIZE_T *si
         if (addr == (void *)1 && !size && type == MEM_RELEASE) virtual_release_address_space();
         else status = STATUS_INVALID_PARAMETER;
     }
-    else if (!(view = find_view( base, size )) || !is_view_valloc( view ))
+    else if (!(view = find_view( base, size )) || !is_view_valloc( view ) ||
+             (view->protect & VPROT_FREE_STACK))
     {
         status = STATUS_INVALID_PARAMETER;
     }
@@ -571,7 +571,7 @@ static void CDECL dummy_surface_set_region( struct window_surface *window_surfac
 
 static void CDECL dummy_surface_flush( struct window_surface *window_surface )
 {
-    /* nothing to do */
+    window_surface->damage.count = 0;
 }
 
 static void CDECL dummy_surface_destroy( struct window_surface *window_surface )
@@ -653,6 +653,7 @@ static void CDECL offscreen_window_surface_flush( struct window_surface *base )
     struct offscreen_window_surface *impl = impl_from_window_surface( base );
     base->funcs->lock( base );
     reset_bounds( &impl->bounds );
+    base->damage.count = 0;
     base->funcs->unlock( base );
 }
 
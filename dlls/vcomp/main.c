@@ -60,6 +60,17 @@ static RTL_CRITICAL_SECTION vcomp_section = { &critsect_debug, -1, 0, 0, 0, 0 };
 #define VCOMP_DYNAMIC_FLAGS_GUIDED      0x03
 #define VCOMP_DYNAMIC_FLAGS_INCREMENT   0x40
 
+/* Number of iterations a thread spins in _vcomp_barrier() before
+ * blocking on the team condition variable. */
+#define VCOMP_BARRIER_SPIN_COUNT        4000
+
+/* The dynamic loop generation and the number of remaining iterations are
+ * kept in a single 64-bit value, so that chunks can be claimed with a
+ * compare-and-swap instead of taking vcomp_section. */
+#define VCOMP_DYNAMIC_STATE(dynamic, iterations) (((LONG64)(dynamic) << 32) | (iterations))
+#define VCOMP_DYNAMIC_STATE_DYNAMIC(state)       ((unsigned int)((ULONG64)(state) >> 32))
+#define VCOMP_DYNAMIC_STATE_ITERATIONS(state)    ((unsigned int)(state))
+
 struct vcomp_thread_data
 {
     struct vcomp_team_data  *team;
@@ -103,6 +114,9 @@ struct vcomp_team_data
 
 struct vcomp_task_data
 {
+    /* dynamic, see VCOMP_DYNAMIC_STATE */
+    LONG64 DECLSPEC_ALIGN(8) dynamic_state;
+
     /* single */
     unsigned int            single;
 
@@ -112,7 +126,6 @@ struct vcomp_task_data
     int                     section_index;
 
     /* dynamic */
-    unsigned int            dynamic;
     unsigned int            dynamic_first;
     unsigned int            dynamic_last;
     unsigned int            dynamic_iterations;
@@ -410,7 +423,7 @@ static struct vcomp_thread_data *vcomp_init_thread_data(void)
 
     data->task.single           = 0;
     data->task.section          = 0;
-    data->task.dynamic          = 0;
+    data->task.dynamic_state    = 0;
 
     thread_data = &data->thread;
     thread_data->team           = NULL;
@@ -1073,6 +1086,28 @@ void CDECL _vcomp_barrier(void)
     else
     {
         unsigned int barrier = team_data->barrier;
+
+        /* Barriers at the end of short parallel regions are usually released
+         * within microseconds, so spin for a while before going to sleep.
+         * Spinning only makes sense if the other threads can run meanwhile. */
+        if (team_data->num_threads <= vcomp_num_procs)
+        {
+            unsigned int i;
+
+            LeaveCriticalSection(&vcomp_section);
+            for (i = 0; i < VCOMP_BARRIER_SPIN_COUNT; ++i)
+            {
+                if (*(volatile unsigned int *)&team_data->barrier != barrier)
+                {
+                    /* pairs with the release done by the last thread leaving the critical section */
+                    MemoryBarrier();
+                    return;
+                }
+                YieldProcessor();
+            }
+            EnterCriticalSection(&vcomp_section);
+        }
+
         while (team_data->barrier == barrier)
             SleepConditionVariableCS(&team_data->cond, &vcomp_section, INFINITE);
     }
@@ -1470,14 +1505,21 @@ void CDECL _vcomp_for_dynamic_init(unsigned int flags, unsigned int first, unsig
         EnterCriticalSection(&vcomp_section);
         thread_data->dynamic++;
         thread_data->dynamic_type = type;
-        if ((int)(thread_data->dynamic - task_data->dynamic) > 0)
+        if ((int)(thread_data->dynamic - VCOMP_DYNAMIC_STATE_DYNAMIC(task_data->dynamic_state)) > 0)
         {
-            task_data->dynamic              = thread_data->dynamic;
+            LONG64 state = task_data->dynamic_state;
+
+            /* Nobody can claim chunks from the previous loop anymore, since
+             * it has no remaining iterations. Publish the new loop only after
+             * its parameters are set. */
             task_data->dynamic_first        = first;
             task_data->dynamic_last         = last;
             task_data->dynamic_iterations   = iterations;
             task_data->dynamic_step         = step;
             task_data->dynamic_chunksize    = chunksize;
+            while (InterlockedCompareExchange64(&task_data->dynamic_state,
+                    VCOMP_DYNAMIC_STATE(thread_data->dynamic, iterations), state) != state)
+                state = task_data->dynamic_state;
         }
         LeaveCriticalSection(&vcomp_section);
     }
@@ -1502,25 +1544,36 @@ int CDECL _vcomp_for_dynamic_next(unsigned int *begin, unsigned int *end)
     else if (thread_data->dynamic_type == VCOMP_DYNAMIC_FLAGS_CHUNKED ||
              thread_data->dynamic_type == VCOMP_DYNAMIC_FLAGS_GUIDED)
     {
-        unsigned int iterations = 0;
-        EnterCriticalSection(&vcomp_section);
-        if (thread_data->dynamic == task_data->dynamic &&
-            task_data->dynamic_iterations != 0)
+        unsigned int iterations, remaining, chunksize;
+        LONG64 state, prev;
+
+        state = InterlockedCompareExchange64(&task_data->dynamic_state, 0, 0);
+        for (;;)
         {
-            iterations = min(task_data->dynamic_iterations, task_data->dynamic_chunksize);
+            remaining = VCOMP_DYNAMIC_STATE_ITERATIONS(state);
+            if (VCOMP_DYNAMIC_STATE_DYNAMIC(state) != thread_data->dynamic || !remaining)
+                return 0;
+
+            /* The loop parameters only change once the loop has no remaining
+             * iterations, in which case the exchange below fails. */
+            chunksize = task_data->dynamic_chunksize;
+            iterations = min(remaining, chunksize);
             if (thread_data->dynamic_type == VCOMP_DYNAMIC_FLAGS_GUIDED &&
-                task_data->dynamic_iterations > num_threads * task_data->dynamic_chunksize)
+                remaining > num_threads * chunksize)
             {
-                iterations = (task_data->dynamic_iterations + num_threads - 1) / num_threads;
+                iterations = (remaining + num_threads - 1) / num_threads;
             }
-            *begin = task_data->dynamic_first;
-            *end   = task_data->dynamic_first + (iterations - 1) * task_data->dynamic_step;
-            task_data->dynamic_iterations -= iterations;
-            task_data->dynamic_first      += iterations * task_data->dynamic_step;
-            if (!task_data->dynamic_iterations)
+            *begin = task_data->dynamic_first + (task_data->dynamic_iterations - remaining) * task_data->dynamic_step;
+            *end   = *begin + (iterations - 1) * task_data->dynamic_step;
+            if (iterations == remaining)
                 *end = task_data->dynamic_last;
+
+            prev = InterlockedCompareExchange64(&task_data->dynamic_state,
+                    VCOMP_DYNAMIC_STATE(thread_data->dynamic, remaining - iterations), state);
+            if (prev == state)
+                break;
+            state = prev;
         }
-        LeaveCriticalSection(&vcomp_section);
         return iterations != 0;
     }
 
@@ -1605,7 +1658,7 @@ void WINAPIV _vcomp_fork(BOOL ifval, int nargs, void *wrapper, ...)
 
     task_data.single            = 0;
     task_data.section           = 0;
-    task_data.dynamic           = 0;
+    task_data.dynamic_state     = 0;
 
     thread_data.team            = &team_data;
     thread_data.task            = &task_data;
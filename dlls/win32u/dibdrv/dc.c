@@ -735,6 +735,7 @@ struct windrv_physdev
     struct dibdrv_physdev *dibdrv;
     struct window_surface *surface;
     DWORD                  start_ticks;
+    RECT                   bounds;  /* bounds of the current drawing operation */
 };
 
 static const struct gdi_dc_funcs window_driver;
@@ -748,11 +749,14 @@ static inline void lock_surface( struct windrv_physdev *dev )
 {
     /* gdi_lock should not be locked */
     dev->surface->funcs->lock( dev->surface );
-    if (is_rect_empty( dev->dibdrv->bounds )) dev->start_ticks = NtGetTickCount();
+    if (is_rect_empty( dev->surface->funcs->get_bounds( dev->surface ))) dev->start_ticks = NtGetTickCount();
+    reset_bounds( &dev->bounds );
 }
 
 static inline void unlock_surface( struct windrv_physdev *dev )
 {
+    add_bounds_rect( dev->surface->funcs->get_bounds( dev->surface ), &dev->bounds );
+    window_surface_add_damage( dev->surface, &dev->bounds );
     dev->surface->funcs->unlock( dev->surface );
     if (NtGetTickCount() - dev->start_ticks > FLUSH_PERIOD) dev->surface->funcs->flush( dev->surface );
 }
@@ -795,7 +799,8 @@ void dibdrv_set_window_surface( DC *dc, struct window_surface *surface )
         init_dib_info_from_bitmapinfo( &dibdrv->dib, info, bits );
         dibdrv->dib.rect = dc->attr->vis_rect;
         offset_rect( &dibdrv->dib.rect, -dc->device_rect.left, -dc->device_rect.top );
-        dibdrv->bounds = surface->funcs->get_bounds( surface );
+        reset_bounds( &physdev->bounds );
+        dibdrv->bounds = &physdev->bounds;
         DC_InitDC( dc );
     }
     else if (windev)
@@ -55,10 +55,17 @@ struct cached_font
     LOGFONTW              lf;
     XFORM                 xform;
     UINT                  aa_flags;
+    LONG                  glyph_size;  /* total size of the cached glyphs */
+    LONG                  hits;
+    LONG                  misses;
     struct cached_glyph **glyphs[GLYPH_NBTYPES][GLYPH_CACHE_PAGES];
 };
 
+#define FONT_CACHE_MIN_UNUSED  5                  /* number of unused fonts always kept around */
+#define FONT_CACHE_MAX_SIZE    (4 * 1024 * 1024)  /* glyph memory above which unused fonts are evicted */
+
 static struct list font_cache = LIST_INIT( font_cache );
+static LONG font_cache_size;
 
 static pthread_mutex_t font_cache_lock = PTHREAD_MUTEX_INITIALIZER;
 
@@ -551,10 +558,47 @@ static int font_cache_cmp( const struct cached_font *p1, const struct cached_fon
     return ret;
 }
 
+static void free_cached_font_glyphs( struct cached_font *font )
+{
+    UINT i, j, k;
+
+    TRACE( "%p: %d bytes of glyphs, %d hits, %d misses\n", font, font->glyph_size, font->hits, font->misses );
+
+    for (i = 0; i < GLYPH_NBTYPES; i++)
+    {
+        for (j = 0; j < GLYPH_CACHE_PAGES; j++)
+        {
+            if (!font->glyphs[i][j]) continue;
+            for (k = 0; k < GLYPH_CACHE_PAGE_SIZE; k++)
+                free( font->glyphs[i][j][k] );
+            free( font->glyphs[i][j] );
+        }
+    }
+    InterlockedExchangeAdd( &font_cache_size, -font->glyph_size );
+}
+
+/* evict the least recently used unused fonts, returning one of them for reuse */
+static struct cached_font *evict_cached_fonts( UINT unused )
+{
+    struct cached_font *ptr, *next, *ret = NULL;
+
+    LIST_FOR_EACH_ENTRY_SAFE_REV( ptr, next, &font_cache, struct cached_font, entry )
+    {
+        if (unused <= FONT_CACHE_MIN_UNUSED && font_cache_size <= FONT_CACHE_MAX_SIZE) break;
+        if (ptr->ref) continue;
+        free_cached_font_glyphs( ptr );
+        list_remove( &ptr->entry );
+        if (ret) free( ret );
+        ret = ptr;
+        unused--;
+    }
+    return ret;
+}
+
 static struct cached_font *add_cached_font( DC *dc, HFONT hfont, UINT aa_flags )
 {
-    struct cached_font font, *ptr, *last_unused = NULL;
-    UINT i = 0, j, k;
+    struct cached_font font, *ptr;
+    UINT unused = 0;
 
     NtGdiExtGetObjectW( hfont, sizeof(font.lf), &font.lf );
     font.xform = dc->xformWorld2Vport;
@@ -578,29 +622,10 @@ static struct cached_font *add_cached_font( DC *dc, HFONT hfont, UINT aa_flags )
             list_remove( &ptr->entry );
             goto done;
         }
-        if (!ptr->ref)
-        {
-            i++;
-            last_unused = ptr;
-        }
+        if (!ptr->ref) unused++;
     }
 
-    if (i > 5)  /* keep at least 5 of the most-recently used fonts around */
-    {
-        ptr = last_unused;
-        for (i = 0; i < GLYPH_NBTYPES; i++)
-        {
-            for (j = 0; j < GLYPH_CACHE_PAGES; j++)
-            {
-                if (!ptr->glyphs[i][j]) continue;
-                for (k = 0; k < GLYPH_CACHE_PAGE_SIZE; k++)
-                    free( ptr->glyphs[i][j][k] );
-                free( ptr->glyphs[i][j] );
-            }
-        }
-        list_remove( &ptr->entry );
-    }
-    else if (!(ptr = malloc( sizeof(*ptr) )))
+    if (!(ptr = evict_cached_fonts( unused )) && !(ptr = malloc( sizeof(*ptr) )))
     {
         pthread_mutex_unlock( &font_cache_lock );
         return NULL;
@@ -608,6 +633,8 @@ static struct cached_font *add_cached_font( DC *dc, HFONT hfont, UINT aa_flags )
 
     *ptr = font;
     ptr->ref = 1;
+    ptr->glyph_size = 0;
+    ptr->hits = ptr->misses = 0;
     memset( ptr->glyphs, 0, sizeof(ptr->glyphs) );
 done:
     list_add_head( &font_cache, &ptr->entry );
@@ -622,7 +649,7 @@ void release_cached_font( struct cached_font *font )
 }
 
 static struct cached_glyph *add_cached_glyph( struct cached_font *font, UINT index, UINT flags,
-                                              struct cached_glyph *glyph )
+                                              struct cached_glyph *glyph, DWORD size )
 {
     struct cached_glyph *ret;
     enum glyph_type type = (flags & ETO_GLYPH_INDEX) ? GLYPH_INDEX : GLYPH_WCHAR;
@@ -643,7 +670,13 @@ static struct cached_glyph *add_cached_glyph( struct cached_font *font, UINT ind
             free( ptr );
     }
     ret = InterlockedCompareExchangePointer( (void **)&font->glyphs[type][page][entry], glyph, NULL );
-    if (!ret) ret = glyph;
+    if (!ret)
+    {
+        size += FIELD_OFFSET( struct cached_glyph, bits );
+        InterlockedExchangeAdd( &font->glyph_size, size );
+        InterlockedExchangeAdd( &font_cache_size, size );
+        ret = glyph;
+    }
     else free( glyph );
     return ret;
 }
@@ -678,27 +711,20 @@ static inline void get_text_bkgnd_masks( DC *dc, const dib_info *dib, rop_mask *
     }
 }
 
-static void draw_glyph( dib_info *dib, int x, int y, const GLYPHMETRICS *metrics,
-                        const dib_info *glyph_dib, DWORD text_color,
+static void draw_glyph( dib_info *dib, const RECT *rect, const dib_info *glyph_dib, DWORD text_color,
                         const struct font_intensities *intensity,
-                        const struct clipped_rects *clipped_rects, RECT *bounds )
+                        const struct clipped_rects *clipped_rects )
 {
     int i;
-    RECT rect, clipped_rect;
+    RECT clipped_rect;
     POINT src_origin;
 
-    rect.left   = x          + metrics->gmptGlyphOrigin.x;
-    rect.top    = y          - metrics->gmptGlyphOrigin.y;
-    rect.right  = rect.left  + metrics->gmBlackBoxX;
-    rect.bottom = rect.top   + metrics->gmBlackBoxY;
-    if (bounds) add_bounds_rect( bounds, &rect );
-
     for (i = 0; i < clipped_rects->count; i++)
     {
-        if (intersect_rect( &clipped_rect, &rect, clipped_rects->rects + i ))
+        if (intersect_rect( &clipped_rect, rect, clipped_rects->rects + i ))
         {
-            src_origin.x = clipped_rect.left - rect.left;
-            src_origin.y = clipped_rect.top  - rect.top;
+            src_origin.x = clipped_rect.left - rect->left;
+            src_origin.y = clipped_rect.top  - rect->top;
 
             if (glyph_dib->bit_count == 32)
                 dib->funcs->draw_subpixel_glyph( dib, &clipped_rect, glyph_dib, &src_origin,
@@ -804,18 +830,98 @@ static struct cached_glyph *cache_glyph_bitmap( DC *dc, struct cached_font *font
 
 done:
     glyph->metrics = metrics;
-    return add_cached_glyph( font, index, flags, glyph );
+    return add_cached_glyph( font, index, flags, glyph, size );
+}
+
+struct glyph_run_entry
+{
+    struct cached_glyph *glyph;
+    RECT                 rect;
+};
+
+/* restrict the clipping rectangles to the bounds of a glyph run */
+static BOOL get_run_clipped_rects( const struct clipped_rects *clipped_rects, const RECT *bounds,
+                                   struct clipped_rects *run_rects )
+{
+    RECT *out;
+    int i;
+
+    init_clipped_rects( run_rects );
+    if (clipped_rects->count > ARRAY_SIZE( run_rects->buffer ) &&
+        !(run_rects->rects = malloc( clipped_rects->count * sizeof(RECT) )))
+    {
+        run_rects->rects = run_rects->buffer;
+        return FALSE;
+    }
+    for (i = 0, out = run_rects->rects; i < clipped_rects->count; i++)
+        if (intersect_rect( out, bounds, clipped_rects->rects + i )) out++;
+    run_rects->count = out - run_rects->rects;
+    return TRUE;
 }
 
 static void render_string( DC *dc, dib_info *dib, struct cached_font *font, INT x, INT y,
                            UINT flags, const WCHAR *str, UINT count, const INT *dx,
                            const struct clipped_rects *clipped_rects, RECT *bounds )
 {
-    UINT i;
+    UINT i, num_glyphs = 0, misses = 0;
+    struct glyph_run_entry run_buffer[64], *run = run_buffer;
+    const struct clipped_rects *run_clip = clipped_rects;
+    struct clipped_rects run_rects;
     struct cached_glyph *glyph;
     dib_info glyph_dib;
     DWORD text_color;
     struct font_intensities intensity;
+    RECT run_bounds;
+
+    if (count > ARRAY_SIZE( run_buffer ) && !(run = malloc( count * sizeof(*run) ))) return;
+
+    /* resolve all the glyphs and their positions first */
+
+    reset_bounds( &run_bounds );
+    for (i = 0; i < count; i++)
+    {
+        if (!(glyph = get_cached_glyph( font, str[i], flags )))
+        {
+            misses++;
+            if (!(glyph = cache_glyph_bitmap( dc, font, str[i], flags ))) continue;
+        }
+
+        run[num_glyphs].glyph       = glyph;
+        run[num_glyphs].rect.left   = x + glyph->metrics.gmptGlyphOrigin.x;
+        run[num_glyphs].rect.top    = y - glyph->metrics.gmptGlyphOrigin.y;
+        run[num_glyphs].rect.right  = run[num_glyphs].rect.left + glyph->metrics.gmBlackBoxX;
+        run[num_glyphs].rect.bottom = run[num_glyphs].rect.top + glyph->metrics.gmBlackBoxY;
+        add_bounds_rect( &run_bounds, &run[num_glyphs].rect );
+        num_glyphs++;
+
+        if (dx)
+        {
+            if (flags & ETO_PDY)
+            {
+                x += dx[ i * 2 ];
+                y += dx[ i * 2 + 1];
+            }
+            else
+                x += dx[ i ];
+        }
+        else
+        {
+            x += glyph->metrics.gmCellIncX;
+            y += glyph->metrics.gmCellIncY;
+        }
+    }
+    InterlockedExchangeAdd( &font->hits, count - misses );
+    InterlockedExchangeAdd( &font->misses, misses );
+
+    if (is_rect_empty( &run_bounds )) goto done;
+    if (bounds) add_bounds_rect( bounds, &run_bounds );
+
+    /* then clip the whole run once, so that each glyph only has to be
+     * checked against the clipping rectangles that it can overlap */
+
+    if (clipped_rects->count > 1 && get_run_clipped_rects( clipped_rects, &run_bounds, &run_rects ))
+        run_clip = &run_rects;
+    if (!run_clip->count) goto done;
 
     glyph_dib.bit_count    = get_glyph_depth( font->aa_flags );
     glyph_dib.rect.left    = 0;
@@ -830,10 +936,10 @@ static void render_string( DC *dc, dib_info *dib, struct cached_font *font, INT
     else
         get_aa_ranges( dib->funcs->pixel_to_colorref( dib, text_color ), intensity.ranges );
 
-    for (i = 0; i < count; i++)
+    for (i = 0; i < num_glyphs; i++)
     {
-        if (!(glyph = get_cached_glyph( font, str[i], flags )) &&
-            !(glyph = cache_glyph_bitmap( dc, font, str[i], flags ))) continue;
+        glyph = run[i].glyph;
+        if (is_rect_empty( &run[i].rect )) continue;
 
         glyph_dib.width       = glyph->metrics.gmBlackBoxX;
         glyph_dib.height      = glyph->metrics.gmBlackBoxY;
@@ -842,24 +948,12 @@ static void render_string( DC *dc, dib_info *dib, struct cached_font *font, INT
         glyph_dib.stride      = get_dib_stride( glyph->metrics.gmBlackBoxX, glyph_dib.bit_count );
         glyph_dib.bits.ptr    = glyph->bits;
 
-        draw_glyph( dib, x, y, &glyph->metrics, &glyph_dib, text_color, &intensity, clipped_rects, bounds );
-
-        if (dx)
-        {
-            if (flags & ETO_PDY)
-            {
-                x += dx[ i * 2 ];
-                y += dx[ i * 2 + 1];
-            }
-            else
-                x += dx[ i ];
-        }
-        else
-        {
-            x += glyph->metrics.gmCellIncX;
-            y += glyph->metrics.gmCellIncY;
-        }
+        draw_glyph( dib, &run[i].rect, &glyph_dib, text_color, &intensity, run_clip );
     }
+
+done:
+    if (run_clip == &run_rects) free_clipped_rects( &run_rects );
+    if (run != run_buffer) free( run );
 }
 
 BOOL render_aa_text_bitmapinfo( DC *dc, BITMAPINFO *info, struct gdi_image_bits *bits,
@@ -1312,16 +1312,156 @@ static void unix_face_destroy( struct unix_face *This )
     free( This );
 }
 
+/* external font faces cache */
+
+struct cached_unix_face
+{
+    DWORD                   mtime;
+    DWORD                   file_size;
+    DWORD                   num_faces;
+    DWORD                   scalable;
+    DWORD                   ntm_flags;
+    DWORD                   font_version;
+    FONTSIGNATURE           fs;
+    struct bitmap_font_size size;
+    WCHAR                   names[1];  /* family, second, style and full names */
+};
+
+static HKEY face_cache_key;
+
+static HKEY get_face_cache_key(void)
+{
+    static const WCHAR face_cacheW[] =
+        {'S','o','f','t','w','a','r','e','\\','W','i','n','e','\\','F','o','n','t','s','\\',
+         'F','a','c','e',' ','C','a','c','h','e'};
+
+    if (!face_cache_key)
+        face_cache_key = reg_create_key( hkcu_key, face_cacheW, sizeof(face_cacheW),
+                                         REG_OPTION_VOLATILE, NULL );
+    return face_cache_key;
+}
+
+static WCHAR *get_face_cache_name( const WCHAR *file, DWORD face_index )
+{
+    UINT len = lstrlenW( file );
+    char index[16];
+    WCHAR *name;
+
+    sprintf( index, ",%u", face_index );
+    if (!(name = malloc( (len + strlen( index ) + 1) * sizeof(WCHAR) ))) return NULL;
+    memcpy( name, file, len * sizeof(WCHAR) );
+    asciiz_to_unicode( name + len, index );
+    return name;
+}
+
+static WCHAR *get_cached_name( const WCHAR **ptr, const WCHAR *end )
+{
+    const WCHAR *name = *ptr;
+    UINT len;
+
+    if (name >= end) return NULL;
+    len = lstrlenW( name );
+    *ptr = name + len + 1;
+    return len ? strdupW( name ) : NULL;
+}
+
+static struct unix_face *unix_face_create_from_cache( const WCHAR *name, const struct stat *st )
+{
+    DWORD buffer[1024];
+    KEY_VALUE_PARTIAL_INFORMATION *info = (KEY_VALUE_PARTIAL_INFORMATION *)buffer;
+    struct cached_unix_face *cached = (struct cached_unix_face *)info->Data;
+    const WCHAR *ptr, *end;
+    struct unix_face *This;
+    ULONG size;
+
+    if (!get_face_cache_key()) return NULL;
+    if (!(size = query_reg_value( face_cache_key, name, info, sizeof(buffer) - sizeof(WCHAR) ))) return NULL;
+    if (info->Type != REG_BINARY || size < sizeof(*cached)) return NULL;
+    if (cached->mtime != (DWORD)st->st_mtime || cached->file_size != (DWORD)st->st_size) return NULL;
+
+    if (!(This = calloc( 1, sizeof(*This) ))) return NULL;
+    This->scalable = cached->scalable;
+    This->num_faces = cached->num_faces;
+    This->ntm_flags = cached->ntm_flags;
+    This->font_version = cached->font_version;
+    This->fs = cached->fs;
+    This->size = cached->size;
+
+    ptr = cached->names;
+    end = (const WCHAR *)((char *)cached + size);
+    *(WCHAR *)end = 0;
+    This->family_name = get_cached_name( &ptr, end );
+    This->second_name = get_cached_name( &ptr, end );
+    This->style_name = get_cached_name( &ptr, end );
+    This->full_name = get_cached_name( &ptr, end );
+
+    if (!This->family_name)
+    {
+        unix_face_destroy( This );
+        return NULL;
+    }
+
+    TRACE( "loaded %s from cache\n", debugstr_w(name) );
+    return This;
+}
+
+static void add_unix_face_to_cache( const WCHAR *name, const struct stat *st, const struct unix_face *face )
+{
+    const WCHAR *names[] = { face->family_name, face->second_name, face->style_name, face->full_name };
+    DWORD buffer[1024];
+    struct cached_unix_face *cached = (struct cached_unix_face *)buffer;
+    WCHAR *ptr = cached->names, *end = (WCHAR *)(buffer + ARRAY_SIZE(buffer));
+    UINT i, len;
+
+    if (!get_face_cache_key()) return;
+
+    memset( cached, 0, sizeof(*cached) );
+    cached->mtime = st->st_mtime;
+    cached->file_size = st->st_size;
+    cached->num_faces = face->num_faces;
+    cached->scalable = face->scalable;
+    cached->ntm_flags = face->ntm_flags;
+    cached->font_version = face->font_version;
+    cached->fs = face->fs;
+    if (!face->scalable) cached->size = face->size;
+
+    for (i = 0; i < ARRAY_SIZE(names); i++)
+    {
+        len = names[i] ? lstrlenW( names[i] ) + 1 : 1;
+        if (ptr + len > end) return;
+        if (names[i]) memcpy( ptr, names[i], len * sizeof(WCHAR) );
+        else *ptr = 0;
+        ptr += len;
+    }
+
+    set_reg_value( face_cache_key, name, REG_BINARY, cached, (char *)ptr - (char *)cached );
+}
+
 static int add_unix_face( const char *unix_name, const WCHAR *file, void *data_ptr, SIZE_T data_size,
                           DWORD face_index, DWORD flags, DWORD *num_faces )
 {
-    struct unix_face *unix_face;
+    struct unix_face *unix_face = NULL;
+    WCHAR *cache_name = NULL;
+    struct stat st;
     int ret;
 
     if (num_faces) *num_faces = 0;
 
-    if (!(unix_face = unix_face_create( unix_name, data_ptr, data_size, face_index, flags )))
-        return 0;
+    /* external fonts are the same for every process, avoid parsing them again */
+    if ((flags & ADDFONT_EXTERNAL_FONT) && unix_name && file && !stat( unix_name, &st ) &&
+        (cache_name = get_face_cache_name( file, face_index )))
+        unix_face = unix_face_create_from_cache( cache_name, &st );
+
+    if (!unix_face)
+    {
+        if (!(unix_face = unix_face_create( unix_name, data_ptr, data_size, face_index, flags )))
+        {
+            free( cache_name );
+            return 0;
+        }
+        if (cache_name) add_unix_face_to_cache( cache_name, &st, unix_face );
+    }
+    free( cache_name );
 
     if (unix_face->family_name[0] == '.') /* Ignore fonts with names beginning with a dot */
     {
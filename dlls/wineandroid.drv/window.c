@@ -730,6 +730,7 @@ static void CDECL android_surface_flush( struct window_surface *window_surface )
              surface->header.rect.bottom - surface->header.rect.top );
     needs_flush = IntersectRect( &rect, &rect, &surface->bounds );
     reset_bounds( &surface->bounds );
+    surface->header.damage.count = 0;
     window_surface->funcs->unlock( window_surface );
     if (!needs_flush) return;
 
@@ -894,6 +895,7 @@ done:
     HeapFree( GetProcessHeap(), 0, surface->region_data );
     surface->region_data = data;
     *window_surface->funcs->get_bounds( window_surface ) = surface->header.rect;
+    window_surface_add_damage( window_surface, &surface->header.rect );
     window_surface->funcs->unlock( window_surface );
     if (region != win_region) DeleteObject( region );
 }
@@ -959,7 +961,10 @@ static void set_surface_layered( struct window_surface *window_surface, BYTE alp
     surface->alpha = alpha;
     set_color_key( surface, color_key );
     if (alpha != prev_alpha || surface->color_key != prev_key)  /* refresh */
+    {
         *window_surface->funcs->get_bounds( window_surface ) = surface->header.rect;
+        window_surface_add_damage( window_surface, &surface->header.rect );
+    }
     window_surface->funcs->unlock( window_surface );
 }
 
@@ -1599,6 +1604,7 @@ BOOL CDECL ANDROID_UpdateLayeredWindow( HWND hwnd, const UPDATELAYEREDWINDOWINFO
     {
         memcpy( dst_bits, src_bits, bmi->bmiHeader.biSizeImage );
         add_bounds_rect( surface->funcs->get_bounds( surface ), &rect );
+        window_surface_add_damage( surface, &rect );
     }
 
     surface->funcs->unlock( surface );
@@ -1633,6 +1639,7 @@ LRESULT CDECL ANDROID_WindowMessage( HWND hwnd, UINT msg, WPARAM wp, LPARAM lp )
             {
                 surface->funcs->lock( surface );
                 *surface->funcs->get_bounds( surface ) = surface->rect;
+                window_surface_add_damage( surface, &surface->rect );
                 surface->funcs->unlock( surface );
                 if (is_argb_surface( surface )) surface->funcs->flush( surface );
             }
@@ -77,12 +77,7 @@ void context_invalidate_compute_state(struct wined3d_context *context, DWORD sta
 
 void context_invalidate_state(struct wined3d_context *context, unsigned int state_id)
 {
-    unsigned int representative = context->state_table[state_id].representative;
-    unsigned int index, shift;
-
-    index = representative / (sizeof(*context->dirty_graphics_states) * CHAR_BIT);
-    shift = representative & ((sizeof(*context->dirty_graphics_states) * CHAR_BIT) - 1);
-    context->dirty_graphics_states[index] |= (1u << shift);
+    wined3d_context_set_graphics_state_dirty(context, context->state_table[state_id].representative);
 }
 
 void wined3d_context_init(struct wined3d_context *context, struct wined3d_swapchain *swapchain)
@@ -2286,6 +2286,8 @@ HRESULT wined3d_context_gl_init(struct wined3d_context_gl *context_gl, struct wi
         gl_info->gl_ops.gl.p_glEnable(GL_TEXTURE_CUBE_MAP_SEAMLESS);
         checkGLcall("enable seamless cube map filtering");
     }
+    if (wined3d_settings.async_shader_compile && gl_info->supported[ARB_PARALLEL_SHADER_COMPILE])
+        GL_EXTCALL(glMaxShaderCompilerThreadsARB(~0u));
     if (gl_info->supported[ARB_CLIP_CONTROL])
         GL_EXTCALL(glPointParameteri(GL_POINT_SPRITE_COORD_ORIGIN, GL_LOWER_LEFT));
 
@@ -4046,20 +4048,30 @@ static BOOL context_apply_draw_state(struct wined3d_context *context,
         }
     }
 
-    for (i = 0, base = 0; i < ARRAY_SIZE(context->dirty_graphics_states); ++i)
+    /* Only visit the words of the dirty state bitmap that have bits set. State
+     * handlers may invalidate further states, so pick up words that became
+     * dirty past the current one. */
+    for (i = 0; i < ARRAY_SIZE(context->dirty_graphics_words); ++i)
     {
-        uint32_t dirty_mask = context->dirty_graphics_states[i];
+        uint32_t word_mask = context->dirty_graphics_words[i];
 
-        while (dirty_mask)
+        while (word_mask)
         {
-            unsigned int state_id = base + wined3d_bit_scan(&dirty_mask);
+            unsigned int word = wined3d_bit_scan(&word_mask);
+            uint32_t dirty_mask = context->dirty_graphics_states[i * 32 + word];
+
+            base = (i * 32 + word) * 32;
+            while (dirty_mask)
+            {
+                unsigned int state_id = base + wined3d_bit_scan(&dirty_mask);
 
-            state_table[state_id].apply(context, state, state_id);
+                state_table[state_id].apply(context, state, state_id);
+            }
+            word_mask = context->dirty_graphics_words[i] & ~(~0u >> (31 - word));
         }
-        base += sizeof(dirty_mask) * CHAR_BIT;
     }
 
-    memset(context->dirty_graphics_states, 0, sizeof(context->dirty_graphics_states));
+    wined3d_context_clear_graphics_states_dirty(context);
 
     if (context->shader_update_mask & ~(1u << WINED3D_SHADER_TYPE_COMPUTE))
     {
@@ -4067,6 +4079,14 @@ static BOOL context_apply_draw_state(struct wined3d_context *context,
         context->shader_update_mask &= 1u << WINED3D_SHADER_TYPE_COMPUTE;
     }
 
+    if (context->shader_program_pending)
+    {
+        /* Try again on the next draw. */
+        context->shader_update_mask |= ((1u << WINED3D_SHADER_TYPE_COUNT) - 1) & ~(1u << WINED3D_SHADER_TYPE_COMPUTE);
+        TRACE("Shaders are still being compiled.\n");
+        return FALSE;
+    }
+
     if (context->constant_update_mask)
     {
         device->shader_backend->shader_load_constants(device->shader_priv, context, state);
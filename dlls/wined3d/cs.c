@@ -3293,6 +3293,7 @@ static void *wined3d_cs_queue_require_space(struct wined3d_cs_queue *queue, size
 
         TRACE("Waiting for free space. Head %u, tail %u, packet size %lu.\n",
                 head, tail, (unsigned long)packet_size);
+        YieldProcessor();
     }
 
     packet = (struct wined3d_cs_packet *)&queue->data[queue->head];
@@ -3985,8 +3986,7 @@ HRESULT CDECL wined3d_deferred_context_record_command_list(struct wined3d_device
             + deferred->query_count * sizeof(*object->queries)
             + deferred->blend_state_count * sizeof(*object->blend_states)
             + deferred->rasterizer_state_count * sizeof(*object->rasterizer_states)
-            + deferred->depth_stencil_state_count * sizeof(*object->depth_stencil_states)
-            + deferred->data_size);
+            + deferred->depth_stencil_state_count * sizeof(*object->depth_stencil_states));
 
     if (!memory)
     {
@@ -4045,9 +4045,14 @@ HRESULT CDECL wined3d_deferred_context_record_command_list(struct wined3d_device
             deferred->depth_stencil_state_count * sizeof(*object->depth_stencil_states));
     /* Transfer our references to the depth stencil states to the command list. */
 
-    object->data = memory;
+    /* Transfer the recorded commands to the command list instead of copying
+     * them. Command lists tend to be recorded repeatedly with similar sizes,
+     * so start the next one with a buffer of the same size. */
+    object->data = deferred->data;
     object->data_size = deferred->data_size;
-    memcpy(object->data, deferred->data, deferred->data_size);
+    deferred->data = NULL;
+    deferred->data_capacity = 0;
+    wined3d_array_reserve(&deferred->data, &deferred->data_capacity, object->data_size, 1);
 
     deferred->data_size = 0;
     deferred->resource_count = 0;
@@ -4081,6 +4086,7 @@ static void wined3d_command_list_destroy_object(void *object)
     for (i = 0; i < list->upload_count; ++i)
         heap_free(list->uploads[i].sysmem);
 
+    heap_free(list->data);
     heap_free(list);
 }
 
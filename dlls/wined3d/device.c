@@ -5879,8 +5879,7 @@ err:
 
 void device_invalidate_state(const struct wined3d_device *device, unsigned int state_id)
 {
-    unsigned int representative, i, idx, shift;
-    struct wined3d_context *context;
+    unsigned int representative, i;
 
     wined3d_from_cs(device->cs);
 
@@ -5892,12 +5891,8 @@ void device_invalidate_state(const struct wined3d_device *device, unsigned int s
     }
 
     representative = device->state_table[state_id].representative;
-    idx = representative / (sizeof(*context->dirty_graphics_states) * CHAR_BIT);
-    shift = representative & ((sizeof(*context->dirty_graphics_states) * CHAR_BIT) - 1);
     for (i = 0; i < device->context_count; ++i)
-    {
-        device->contexts[i]->dirty_graphics_states[idx] |= (1u << shift);
-    }
+        wined3d_context_set_graphics_state_dirty(device->contexts[i], representative);
 }
 
 LRESULT device_process_message(struct wined3d_device *device, HWND window, BOOL unicode,
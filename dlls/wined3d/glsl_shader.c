@@ -38,6 +38,7 @@
 
 WINE_DEFAULT_DEBUG_CHANNEL(d3d_shader);
 WINE_DECLARE_DEBUG_CHANNEL(d3d);
+WINE_DECLARE_DEBUG_CHANNEL(d3d_perf);
 WINE_DECLARE_DEBUG_CHANNEL(winediag);
 
 #define WINED3D_GLSL_SAMPLE_PROJECTED   0x01
@@ -254,7 +255,10 @@ struct glsl_shader_prog_link
     unsigned int constant_version;
     DWORD shader_controlled_clip_distances : 1;
     DWORD clip_distance_mask : 8; /* WINED3D_MAX_CLIP_DISTANCES, 8 */
-    DWORD padding : 23;
+    DWORD link_pending : 1;
+    DWORD cache_binary : 1;
+    DWORD padding : 21;
+    UINT64 cache_hash;
 };
 
 struct glsl_program_key
@@ -548,6 +552,11 @@ void print_glsl_info_log(const struct wined3d_gl_info *gl_info, GLuint id, BOOL
     }
 }
 
+static BOOL shader_glsl_use_async_compile(const struct wined3d_gl_info *gl_info)
+{
+    return wined3d_settings.async_shader_compile && gl_info->supported[ARB_PARALLEL_SHADER_COMPILE];
+}
+
 /* Context activation is done by the caller. */
 static void shader_glsl_compile(const struct wined3d_gl_info *gl_info, GLuint shader, const char *src)
 {
@@ -565,7 +574,10 @@ static void shader_glsl_compile(const struct wined3d_gl_info *gl_info, GLuint sh
     checkGLcall("glShaderSource");
     GL_EXTCALL(glCompileShader(shader));
     checkGLcall("glCompileShader");
-    print_glsl_info_log(gl_info, shader, FALSE);
+    /* Querying the info log would wait for the compile to finish. With
+     * asynchronous compilation it's printed once the shader is ready. */
+    if (!shader_glsl_use_async_compile(gl_info))
+        print_glsl_info_log(gl_info, shader, FALSE);
 }
 
 /* Context activation is done by the caller. */
@@ -638,6 +650,204 @@ void shader_glsl_validate_link(const struct wined3d_gl_info *gl_info, GLuint pro
     print_glsl_info_log(gl_info, program, TRUE);
 }
 
+/* Persistent GLSL program binary cache. It is enabled by setting the
+ * "ShaderCachePath" registry value to an existing directory. Programs are
+ * identified by the renderer and driver version, the source of their
+ * attached shaders and the state bound before linking that isn't part of
+ * that source. The shaders are still generated and compiled; a cache hit
+ * only replaces the program link. */
+#define WINED3D_GLSL_CACHE_MAGIC 0x43534c47 /* "GLSC" */
+
+struct glsl_program_cache_header
+{
+    DWORD magic;
+    GLenum format;
+    DWORD size;
+};
+
+static LONG glsl_program_cache_hits, glsl_program_cache_misses;
+
+static UINT64 shader_glsl_hash(UINT64 hash, const void *data, size_t size)
+{
+    const BYTE *ptr = data;
+
+    while (size--)
+    {
+        hash ^= *ptr++;
+        hash *= 0x100000001b3ull;
+    }
+    return hash;
+}
+
+static int __cdecl compare_uint64(const void *a, const void *b)
+{
+    const UINT64 *x = a, *y = b;
+
+    return (*x > *y) - (*x < *y);
+}
+
+/* Context activation is done by the caller. */
+static BOOL shader_glsl_get_program_hash(const struct wined3d_gl_info *gl_info, GLuint program,
+        DWORD link_flags, UINT64 *hash)
+{
+    UINT64 shader_hashes[WINED3D_SHADER_TYPE_COUNT + 1];
+    GLuint shaders[WINED3D_SHADER_TYPE_COUNT + 1];
+    GLint count, length, size = 0, i;
+    const char *renderer, *version;
+    char *source = NULL, *tmp;
+
+    if (!(renderer = (const char *)gl_info->gl_ops.gl.p_glGetString(GL_RENDERER))
+            || !(version = (const char *)gl_info->gl_ops.gl.p_glGetString(GL_VERSION)))
+        return FALSE;
+    *hash = shader_glsl_hash(0xcbf29ce484222325ull, renderer, strlen(renderer) + 1);
+    *hash = shader_glsl_hash(*hash, version, strlen(version) + 1);
+    *hash = shader_glsl_hash(*hash, &link_flags, sizeof(link_flags));
+
+    GL_EXTCALL(glGetAttachedShaders(program, ARRAY_SIZE(shaders), &count, shaders));
+    for (i = 0; i < count; ++i)
+    {
+        GL_EXTCALL(glGetShaderiv(shaders[i], GL_SHADER_SOURCE_LENGTH, &length));
+        if (length > size)
+        {
+            if (!(tmp = heap_realloc(source, length)))
+            {
+                heap_free(source);
+                return FALSE;
+            }
+            source = tmp;
+            size = length;
+        }
+        GL_EXTCALL(glGetShaderSource(shaders[i], size, &length, source));
+        shader_hashes[i] = shader_glsl_hash(0xcbf29ce484222325ull, source, length);
+    }
+    checkGLcall("get program hash");
+    heap_free(source);
+
+    /* The order of attached shaders isn't specified, so sort their hashes
+     * before chaining them. */
+    qsort(shader_hashes, count, sizeof(*shader_hashes), compare_uint64);
+    *hash = shader_glsl_hash(*hash, shader_hashes, count * sizeof(*shader_hashes));
+
+    return count > 0;
+}
+
+static HANDLE shader_glsl_open_program_cache_file(UINT64 hash, BOOL create)
+{
+    char path[MAX_PATH];
+
+    if (snprintf(path, sizeof(path), "%s\\%08x%08x.bin", wined3d_settings.shader_cache_path,
+            (unsigned int)(hash >> 32), (unsigned int)hash) >= sizeof(path))
+        return INVALID_HANDLE_VALUE;
+
+    if (create)
+        return CreateFileA(path, GENERIC_WRITE, 0, NULL, CREATE_ALWAYS, 0, NULL);
+    return CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, 0, NULL);
+}
+
+/* Context activation is done by the caller. */
+static BOOL shader_glsl_load_program_binary(const struct wined3d_gl_info *gl_info, GLuint program, UINT64 hash)
+{
+    struct glsl_program_cache_header header;
+    GLint status = GL_FALSE;
+    void *binary;
+    HANDLE file;
+    DWORD size;
+
+    if ((file = shader_glsl_open_program_cache_file(hash, FALSE)) == INVALID_HANDLE_VALUE)
+        return FALSE;
+
+    if (ReadFile(file, &header, sizeof(header), &size, NULL) && size == sizeof(header)
+            && header.magic == WINED3D_GLSL_CACHE_MAGIC && (binary = heap_alloc(header.size)))
+    {
+        if (ReadFile(file, binary, header.size, &size, NULL) && size == header.size)
+        {
+            GL_EXTCALL(glProgramBinary(program, header.format, binary, header.size));
+            GL_EXTCALL(glGetProgramiv(program, GL_LINK_STATUS, &status));
+            checkGLcall("glProgramBinary");
+        }
+        heap_free(binary);
+    }
+    CloseHandle(file);
+
+    return status == GL_TRUE;
+}
+
+/* Context activation is done by the caller. */
+static void shader_glsl_store_program_binary(const struct wined3d_gl_info *gl_info, GLuint program, UINT64 hash)
+{
+    struct glsl_program_cache_header header;
+    GLint status, length = 0;
+    GLsizei size;
+    void *binary;
+    HANDLE file;
+    DWORD written;
+
+    GL_EXTCALL(glGetProgramiv(program, GL_LINK_STATUS, &status));
+    if (!status)
+        return;
+    GL_EXTCALL(glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length));
+    if (length <= 0 || !(binary = heap_alloc(length)))
+        return;
+    GL_EXTCALL(glGetProgramBinary(program, length, &size, &header.format, binary));
+    checkGLcall("glGetProgramBinary");
+
+    header.magic = WINED3D_GLSL_CACHE_MAGIC;
+    header.size = size;
+    if ((file = shader_glsl_open_program_cache_file(hash, TRUE)) != INVALID_HANDLE_VALUE)
+    {
+        if (!WriteFile(file, &header, sizeof(header), &written, NULL)
+                || !WriteFile(file, binary, size, &written, NULL))
+            WARN("Failed to write program %u to the shader cache.\n", program);
+        CloseHandle(file);
+    }
+    heap_free(binary);
+}
+
+/* Context activation is done by the caller. */
+static void shader_glsl_finish_link(const struct wined3d_gl_info *gl_info, struct glsl_shader_prog_link *entry)
+{
+    shader_glsl_validate_link(gl_info, entry->id);
+
+    if (entry->cache_binary)
+        shader_glsl_store_program_binary(gl_info, entry->id, entry->cache_hash);
+    entry->cache_binary = 0;
+}
+
+/* Context activation is done by the caller. Returns FALSE if the program is
+ * still being linked by the driver, in which case shader_glsl_finish_link()
+ * has to be called once GL_COMPLETION_STATUS_ARB reports it's done. */
+static BOOL shader_glsl_link_program(const struct wined3d_gl_info *gl_info, struct glsl_shader_prog_link *entry,
+        DWORD link_flags, BOOL cacheable, BOOL async)
+{
+    GLuint program = entry->id;
+
+    entry->cache_binary = cacheable && wined3d_settings.shader_cache_path
+            && gl_info->supported[ARB_GET_PROGRAM_BINARY]
+            && shader_glsl_get_program_hash(gl_info, program, link_flags, &entry->cache_hash);
+
+    if (entry->cache_binary)
+    {
+        if (shader_glsl_load_program_binary(gl_info, program, entry->cache_hash))
+        {
+            TRACE("Loaded GLSL shader program %u from the shader cache.\n", program);
+            InterlockedIncrement(&glsl_program_cache_hits);
+            entry->cache_binary = 0;
+            return TRUE;
+        }
+        WARN_(d3d_perf)("GLSL shader program %u not found in the shader cache, %d hits, %d misses.\n", program,
+                glsl_program_cache_hits, InterlockedIncrement(&glsl_program_cache_misses));
+        GL_EXTCALL(glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE));
+    }
+
+    TRACE("Linking GLSL shader program %u.\n", program);
+    GL_EXTCALL(glLinkProgram(program));
+    if (async && shader_glsl_use_async_compile(gl_info))
+        return FALSE;
+
+    shader_glsl_finish_link(gl_info, entry);
+    return TRUE;
+}
+
 static BOOL shader_glsl_use_layout_qualifier(const struct wined3d_gl_info *gl_info)
 {
     /* Layout qualifiers were introduced in GLSL 1.40. The Nvidia Legacy GPU
@@ -10148,6 +10358,7 @@ static HRESULT shader_glsl_compile_compute_shader(struct shader_glsl_priv *priv,
     entry->constant_version = 0;
     entry->shader_controlled_clip_distances = 0;
     entry->ps.np2_fixup_info = NULL;
+    entry->link_pending = 0;
     add_glsl_program_entry(priv, entry);
 
     TRACE("Attaching GLSL shader object %u to program %u.\n", shader_id, program_id);
@@ -10156,9 +10367,10 @@ static HRESULT shader_glsl_compile_compute_shader(struct shader_glsl_priv *priv,
 
     list_add_head(&shader->linked_programs, &entry->cs.shader_entry);
 
-    TRACE("Linking GLSL shader program %u.\n", program_id);
-    GL_EXTCALL(glLinkProgram(program_id));
-    shader_glsl_validate_link(gl_info, program_id);
+    /* Compute shaders are compiled and linked synchronously. */
+    shader_glsl_link_program(gl_info, entry, 0, TRUE, FALSE);
+    if (shader_glsl_use_async_compile(gl_info))
+        print_glsl_info_log(gl_info, shader_id, FALSE);
 
     GL_EXTCALL(glUseProgram(program_id));
     checkGLcall("glUseProgram");
@@ -10218,12 +10430,240 @@ static void set_glsl_compute_shader_program(const struct wined3d_context_gl *con
 }
 
 /* Context activation is done by the caller. */
-static void set_glsl_shader_program(const struct wined3d_context_gl *context_gl, const struct wined3d_state *state,
+static BOOL shader_glsl_program_shaders_ready(const struct wined3d_gl_info *gl_info,
+        const struct glsl_program_key *key)
+{
+    const GLuint ids[] = {key->vs_id, key->hs_id, key->ds_id, key->gs_id, key->ps_id};
+    unsigned int i;
+    GLint status;
+
+    if (!shader_glsl_use_async_compile(gl_info))
+        return TRUE;
+
+    for (i = 0; i < ARRAY_SIZE(ids); ++i)
+    {
+        if (!ids[i])
+            continue;
+        GL_EXTCALL(glGetShaderiv(ids[i], GL_COMPLETION_STATUS_ARB, &status));
+        checkGLcall("glGetShaderiv(GL_COMPLETION_STATUS_ARB)");
+        if (!status)
+        {
+            TRACE("Shader object %u is still being compiled.\n", ids[i]);
+            return FALSE;
+        }
+    }
+
+    /* shader_glsl_compile() doesn't print the info log of shaders compiled
+     * asynchronously. Shader objects shared between several programs have
+     * their log printed for each of them. */
+    for (i = 0; i < ARRAY_SIZE(ids); ++i)
+    {
+        if (ids[i])
+            print_glsl_info_log(gl_info, ids[i], FALSE);
+    }
+
+    return TRUE;
+}
+
+/* Context activation is done by the caller. */
+static void shader_glsl_init_program(const struct wined3d_context_gl *context_gl, struct shader_glsl_priv *priv,
+        struct glsl_shader_prog_link *entry, const struct wined3d_shader *vshader,
+        const struct wined3d_shader *hshader, const struct wined3d_shader *dshader,
+        const struct wined3d_shader *gshader, const struct wined3d_shader *pshader)
+{
+    const struct wined3d_gl_info *gl_info = context_gl->gl_info;
+    const struct wined3d_shader *pre_rasterization_shader;
+    GLuint program_id = entry->id;
+    unsigned int i;
+
+    shader_glsl_init_vs_uniform_locations(gl_info, priv, program_id, &entry->vs,
+            vshader ? vshader->limits->constant_float : 0);
+    shader_glsl_init_ds_uniform_locations(gl_info, priv, program_id, &entry->ds);
+    shader_glsl_init_gs_uniform_locations(gl_info, priv, program_id, &entry->gs);
+    shader_glsl_init_ps_uniform_locations(gl_info, priv, program_id, &entry->ps,
+            pshader ? pshader->limits->constant_float : 0);
+    checkGLcall("find glsl program uniform locations");
+
+    pre_rasterization_shader = gshader ? gshader : dshader ? dshader : vshader;
+    if (pre_rasterization_shader && pre_rasterization_shader->reg_maps.shader_version.major >= 4)
+    {
+        unsigned int clip_distance_count = wined3d_popcount(pre_rasterization_shader->reg_maps.clip_distance_mask);
+        entry->shader_controlled_clip_distances = 1;
+        entry->clip_distance_mask = (1u << clip_distance_count) - 1;
+    }
+
+    if (needs_legacy_glsl_syntax(gl_info))
+    {
+        if (pshader && pshader->reg_maps.shader_version.major >= 3
+                && pshader->u.ps.declared_in_count > vec4_varyings(3, gl_info))
+        {
+            TRACE("Shader %d needs vertex color clamping disabled.\n", program_id);
+            entry->vs.vertex_color_clamp = GL_FALSE;
+        }
+        else
+        {
+            entry->vs.vertex_color_clamp = GL_FIXED_ONLY_ARB;
+        }
+    }
+    else
+    {
+        /* With core profile we never change vertex_color_clamp from
+         * GL_FIXED_ONLY_MODE (which is also the initial value) so we never call
+         * glClampColorARB(). */
+        entry->vs.vertex_color_clamp = GL_FIXED_ONLY_ARB;
+    }
+
+    /* Set the shader to allow uniform loading on it */
+    GL_EXTCALL(glUseProgram(program_id));
+    checkGLcall("glUseProgram");
+
+    entry->constant_update_mask = 0;
+    if (vshader)
+    {
+        entry->constant_update_mask |= WINED3D_SHADER_CONST_VS_F;
+        if (vshader->reg_maps.integer_constants)
+            entry->constant_update_mask |= WINED3D_SHADER_CONST_VS_I;
+        if (vshader->reg_maps.boolean_constants)
+            entry->constant_update_mask |= WINED3D_SHADER_CONST_VS_B;
+        if (entry->vs.pos_fixup_location != -1)
+            entry->constant_update_mask |= WINED3D_SHADER_CONST_POS_FIXUP;
+        if (entry->vs.base_vertex_id_location != -1)
+            entry->constant_update_mask |= WINED3D_SHADER_CONST_BASE_VERTEX_ID;
+
+        shader_glsl_load_program_resources(context_gl, priv, program_id, vshader);
+    }
+    else
+    {
+        entry->constant_update_mask |= WINED3D_SHADER_CONST_FFP_MODELVIEW
+                | WINED3D_SHADER_CONST_FFP_PROJ;
+
+        for (i = 1; i < MAX_VERTEX_BLENDS; ++i)
+        {
+            if (entry->vs.modelview_matrix_location[i] != -1)
+            {
+                entry->constant_update_mask |= WINED3D_SHADER_CONST_FFP_VERTEXBLEND;
+                break;
+            }
+        }
+
+        for (i = 0; i < WINED3D_MAX_TEXTURES; ++i)
+        {
+            if (entry->vs.texture_matrix_location[i] != -1)
+            {
+                entry->constant_update_mask |= WINED3D_SHADER_CONST_FFP_TEXMATRIX;
+                break;
+            }
+        }
+        if (entry->vs.material_ambient_location != -1 || entry->vs.material_diffuse_location != -1
+                || entry->vs.material_specular_location != -1
+                || entry->vs.material_emissive_location != -1
+                || entry->vs.material_shininess_location != -1)
+            entry->constant_update_mask |= WINED3D_SHADER_CONST_FFP_MATERIAL;
+        if (entry->vs.light_ambient_location != -1)
+            entry->constant_update_mask |= WINED3D_SHADER_CONST_FFP_LIGHTS;
+    }
+    if (entry->vs.clip_planes_location != -1)
+        entry->constant_update_mask |= WINED3D_SHADER_CONST_VS_CLIP_PLANES;
+    if (entry->vs.pointsize_min_location != -1)
+        entry->constant_update_mask |= WINED3D_SHADER_CONST_VS_POINTSIZE;
+
+    if (hshader)
+        shader_glsl_load_program_resources(context_gl, priv, program_id, hshader);
+
+    if (dshader)
+    {
+        if (entry->ds.pos_fixup_location != -1)
+            entry->constant_update_mask |= WINED3D_SHADER_CONST_POS_FIXUP;
+
+        shader_glsl_load_program_resources(context_gl, priv, program_id, dshader);
+    }
+
+    if (gshader)
+    {
+        if (entry->gs.pos_fixup_location != -1)
+            entry->constant_update_mask |= WINED3D_SHADER_CONST_POS_FIXUP;
+
+        shader_glsl_load_program_resources(context_gl, priv, program_id, gshader);
+    }
+
+    if (entry->ps.id)
+    {
+        if (pshader)
+        {
+            entry->constant_update_mask |= WINED3D_SHADER_CONST_PS_F;
+            if (pshader->reg_maps.integer_constants)
+                entry->constant_update_mask |= WINED3D_SHADER_CONST_PS_I;
+            if (pshader->reg_maps.boolean_constants)
+                entry->constant_update_mask |= WINED3D_SHADER_CONST_PS_B;
+            if (entry->ps.ycorrection_location != -1)
+                entry->constant_update_mask |= WINED3D_SHADER_CONST_PS_Y_CORR;
+
+            shader_glsl_load_program_resources(context_gl, priv, program_id, pshader);
+            shader_glsl_load_images(gl_info, priv, program_id, &pshader->reg_maps);
+        }
+        else
+        {
+            entry->constant_update_mask |= WINED3D_SHADER_CONST_FFP_PS;
+
+            shader_glsl_load_samplers(&context_gl->c, priv, program_id, NULL);
+        }
+
+        for (i = 0; i < WINED3D_MAX_TEXTURES; ++i)
+        {
+            if (entry->ps.bumpenv_mat_location[i] != -1)
+            {
+                entry->constant_update_mask |= WINED3D_SHADER_CONST_PS_BUMP_ENV;
+                break;
+            }
+        }
+
+        if (entry->ps.fog_color_location != -1)
+            entry->constant_update_mask |= WINED3D_SHADER_CONST_PS_FOG;
+        if (entry->ps.alpha_test_ref_location != -1)
+            entry->constant_update_mask |= WINED3D_SHADER_CONST_PS_ALPHA_TEST;
+        if (entry->ps.np2_fixup_location != -1)
+            entry->constant_update_mask |= WINED3D_SHADER_CONST_PS_NP2_FIXUP;
+        if (entry->ps.color_key_location != -1)
+            entry->constant_update_mask |= WINED3D_SHADER_CONST_FFP_COLOR_KEY;
+    }
+}
+
+/* Context activation is done by the caller. Returns FALSE while the program
+ * is still being linked asynchronously. */
+static BOOL shader_glsl_complete_program(const struct wined3d_context_gl *context_gl,
+        struct shader_glsl_priv *priv, struct glsl_shader_prog_link *entry, const struct wined3d_shader *vshader,
+        const struct wined3d_shader *hshader, const struct wined3d_shader *dshader,
+        const struct wined3d_shader *gshader, const struct wined3d_shader *pshader)
+{
+    const struct wined3d_gl_info *gl_info = context_gl->gl_info;
+    GLint status;
+
+    if (!entry->link_pending)
+        return TRUE;
+
+    GL_EXTCALL(glGetProgramiv(entry->id, GL_COMPLETION_STATUS_ARB, &status));
+    checkGLcall("glGetProgramiv(GL_COMPLETION_STATUS_ARB)");
+    if (!status)
+    {
+        TRACE("Program %u is still being linked.\n", entry->id);
+        return FALSE;
+    }
+
+    entry->link_pending = 0;
+    shader_glsl_finish_link(gl_info, entry);
+    shader_glsl_init_program(context_gl, priv, entry, vshader, hshader, dshader, gshader, pshader);
+
+    return TRUE;
+}
+
+/* Context activation is done by the caller. Returns FALSE if the program
+ * can't be used yet because its shaders are still being compiled or it is
+ * still being linked. */
+static BOOL set_glsl_shader_program(const struct wined3d_context_gl *context_gl, const struct wined3d_state *state,
         struct shader_glsl_priv *priv, struct glsl_context_data *ctx_data)
 {
     const struct wined3d_d3d_info *d3d_info = context_gl->c.d3d_info;
     const struct wined3d_gl_info *gl_info = context_gl->gl_info;
-    const struct wined3d_shader *pre_rasterization_shader;
     const struct ps_np2fixup_info *np2fixup_info = NULL;
     struct wined3d_shader *hshader, *dshader, *gshader;
     struct glsl_shader_prog_link *entry = NULL;
@@ -10347,8 +10787,20 @@ static void set_glsl_shader_program(const struct wined3d_context_gl *context_gl,
     key.cs_id = 0;
     if ((!vs_id && !hs_id && !ds_id && !gs_id && !ps_id) || (entry = get_glsl_program_entry(priv, &key)))
     {
+        if (entry && !shader_glsl_complete_program(context_gl, priv, entry,
+                vshader, hshader, dshader, gshader, pshader))
+        {
+            ctx_data->glsl_program = NULL;
+            return FALSE;
+        }
         ctx_data->glsl_program = entry;
-        return;
+        return TRUE;
+    }
+
+    if (!shader_glsl_program_shaders_ready(gl_info, &key))
+    {
+        ctx_data->glsl_program = NULL;
+        return FALSE;
     }
 
     /* If we get to this point, then no matching program exists, so we create one */
@@ -10488,173 +10940,66 @@ static void set_glsl_shader_program(const struct wined3d_context_gl *context_gl,
         list_add_head(ps_list, &entry->ps.shader_entry);
     }
 
-    /* Link the program */
-    TRACE("Linking GLSL shader program %u.\n", program_id);
-    GL_EXTCALL(glLinkProgram(program_id));
-    shader_glsl_validate_link(gl_info, program_id);
-
-    shader_glsl_init_vs_uniform_locations(gl_info, priv, program_id, &entry->vs,
-            vshader ? vshader->limits->constant_float : 0);
-    shader_glsl_init_ds_uniform_locations(gl_info, priv, program_id, &entry->ds);
-    shader_glsl_init_gs_uniform_locations(gl_info, priv, program_id, &entry->gs);
-    shader_glsl_init_ps_uniform_locations(gl_info, priv, program_id, &entry->ps,
-            pshader ? pshader->limits->constant_float : 0);
-    checkGLcall("find glsl program uniform locations");
-
-    pre_rasterization_shader = gshader ? gshader : dshader ? dshader : vshader;
-    if (pre_rasterization_shader && pre_rasterization_shader->reg_maps.shader_version.major >= 4)
-    {
-        unsigned int clip_distance_count = wined3d_popcount(pre_rasterization_shader->reg_maps.clip_distance_mask);
-        entry->shader_controlled_clip_distances = 1;
-        entry->clip_distance_mask = (1u << clip_distance_count) - 1;
-    }
-
-    if (needs_legacy_glsl_syntax(gl_info))
+    /* Link the program. Transform feedback varyings aren't part of the
+     * shader source, so programs using them aren't cached. */
+    entry->link_pending = !shader_glsl_link_program(gl_info, entry,
+            state->blend_state && state->blend_state->dual_source, !gshader || !gshader->u.gs.so_desc, TRUE);
+    if (entry->link_pending)
     {
-        if (pshader && pshader->reg_maps.shader_version.major >= 3
-                && pshader->u.ps.declared_in_count > vec4_varyings(3, gl_info))
-        {
-            TRACE("Shader %d needs vertex color clamping disabled.\n", program_id);
-            entry->vs.vertex_color_clamp = GL_FALSE;
-        }
-        else
-        {
-            entry->vs.vertex_color_clamp = GL_FIXED_ONLY_ARB;
-        }
-    }
-    else
-    {
-        /* With core profile we never change vertex_color_clamp from
-         * GL_FIXED_ONLY_MODE (which is also the initial value) so we never call
-         * glClampColorARB(). */
-        entry->vs.vertex_color_clamp = GL_FIXED_ONLY_ARB;
-    }
-
-    /* Set the shader to allow uniform loading on it */
-    GL_EXTCALL(glUseProgram(program_id));
-    checkGLcall("glUseProgram");
-
-    entry->constant_update_mask = 0;
-    if (vshader)
-    {
-        entry->constant_update_mask |= WINED3D_SHADER_CONST_VS_F;
-        if (vshader->reg_maps.integer_constants)
-            entry->constant_update_mask |= WINED3D_SHADER_CONST_VS_I;
-        if (vshader->reg_maps.boolean_constants)
-            entry->constant_update_mask |= WINED3D_SHADER_CONST_VS_B;
-        if (entry->vs.pos_fixup_location != -1)
-            entry->constant_update_mask |= WINED3D_SHADER_CONST_POS_FIXUP;
-        if (entry->vs.base_vertex_id_location != -1)
-            entry->constant_update_mask |= WINED3D_SHADER_CONST_BASE_VERTEX_ID;
-
-        shader_glsl_load_program_resources(context_gl, priv, program_id, vshader);
-    }
-    else
-    {
-        entry->constant_update_mask |= WINED3D_SHADER_CONST_FFP_MODELVIEW
-                | WINED3D_SHADER_CONST_FFP_PROJ;
-
-        for (i = 1; i < MAX_VERTEX_BLENDS; ++i)
-        {
-            if (entry->vs.modelview_matrix_location[i] != -1)
-            {
-                entry->constant_update_mask |= WINED3D_SHADER_CONST_FFP_VERTEXBLEND;
-                break;
-            }
-        }
-
-        for (i = 0; i < WINED3D_MAX_TEXTURES; ++i)
-        {
-            if (entry->vs.texture_matrix_location[i] != -1)
-            {
-                entry->constant_update_mask |= WINED3D_SHADER_CONST_FFP_TEXMATRIX;
-                break;
-            }
-        }
-        if (entry->vs.material_ambient_location != -1 || entry->vs.material_diffuse_location != -1
-                || entry->vs.material_specular_location != -1
-                || entry->vs.material_emissive_location != -1
-                || entry->vs.material_shininess_location != -1)
-            entry->constant_update_mask |= WINED3D_SHADER_CONST_FFP_MATERIAL;
-        if (entry->vs.light_ambient_location != -1)
-            entry->constant_update_mask |= WINED3D_SHADER_CONST_FFP_LIGHTS;
-    }
-    if (entry->vs.clip_planes_location != -1)
-        entry->constant_update_mask |= WINED3D_SHADER_CONST_VS_CLIP_PLANES;
-    if (entry->vs.pointsize_min_location != -1)
-        entry->constant_update_mask |= WINED3D_SHADER_CONST_VS_POINTSIZE;
-
-    if (hshader)
-        shader_glsl_load_program_resources(context_gl, priv, program_id, hshader);
-
-    if (dshader)
-    {
-        if (entry->ds.pos_fixup_location != -1)
-            entry->constant_update_mask |= WINED3D_SHADER_CONST_POS_FIXUP;
-
-        shader_glsl_load_program_resources(context_gl, priv, program_id, dshader);
-    }
-
-    if (gshader)
-    {
-        if (entry->gs.pos_fixup_location != -1)
-            entry->constant_update_mask |= WINED3D_SHADER_CONST_POS_FIXUP;
-
-        shader_glsl_load_program_resources(context_gl, priv, program_id, gshader);
+        ctx_data->glsl_program = NULL;
+        return FALSE;
     }
 
-    if (ps_id)
-    {
-        if (pshader)
-        {
-            entry->constant_update_mask |= WINED3D_SHADER_CONST_PS_F;
-            if (pshader->reg_maps.integer_constants)
-                entry->constant_update_mask |= WINED3D_SHADER_CONST_PS_I;
-            if (pshader->reg_maps.boolean_constants)
-                entry->constant_update_mask |= WINED3D_SHADER_CONST_PS_B;
-            if (entry->ps.ycorrection_location != -1)
-                entry->constant_update_mask |= WINED3D_SHADER_CONST_PS_Y_CORR;
-
-            shader_glsl_load_program_resources(context_gl, priv, program_id, pshader);
-            shader_glsl_load_images(gl_info, priv, program_id, &pshader->reg_maps);
-        }
-        else
-        {
-            entry->constant_update_mask |= WINED3D_SHADER_CONST_FFP_PS;
-
-            shader_glsl_load_samplers(&context_gl->c, priv, program_id, NULL);
-        }
+    shader_glsl_init_program(context_gl, priv, entry, vshader, hshader, dshader, gshader, pshader);
 
-        for (i = 0; i < WINED3D_MAX_TEXTURES; ++i)
-        {
-            if (entry->ps.bumpenv_mat_location[i] != -1)
-            {
-                entry->constant_update_mask |= WINED3D_SHADER_CONST_PS_BUMP_ENV;
-                break;
-            }
-        }
-
-        if (entry->ps.fog_color_location != -1)
-            entry->constant_update_mask |= WINED3D_SHADER_CONST_PS_FOG;
-        if (entry->ps.alpha_test_ref_location != -1)
-            entry->constant_update_mask |= WINED3D_SHADER_CONST_PS_ALPHA_TEST;
-        if (entry->ps.np2_fixup_location != -1)
-            entry->constant_update_mask |= WINED3D_SHADER_CONST_PS_NP2_FIXUP;
-        if (entry->ps.color_key_location != -1)
-            entry->constant_update_mask |= WINED3D_SHADER_CONST_FFP_COLOR_KEY;
-    }
+    return TRUE;
 }
 
 static void shader_glsl_precompile(void *shader_priv, struct wined3d_shader *shader)
 {
+    const struct ps_np2fixup_info *np2fixup_info;
     struct wined3d_device *device = shader->device;
+    const struct wined3d_state *state = &device->cs->state;
+    struct shader_glsl_priv *priv = shader_priv;
+    struct wined3d_context_gl *context_gl;
+    struct vs_compile_args vs_args;
+    struct ps_compile_args ps_args;
     struct wined3d_context *context;
 
-    if (shader->reg_maps.shader_version.type == WINED3D_SHADER_TYPE_COMPUTE)
+    switch (shader->reg_maps.shader_version.type)
     {
-        context = context_acquire(device, NULL, 0);
-        shader_glsl_compile_compute_shader(shader_priv, wined3d_context_gl(context), shader);
-        context_release(context);
+        case WINED3D_SHADER_TYPE_COMPUTE:
+            context = context_acquire(device, NULL, 0);
+            shader_glsl_compile_compute_shader(shader_priv, wined3d_context_gl(context), shader);
+            context_release(context);
+            break;
+
+        /* With asynchronous compilation, start compiling the variant matching
+         * the current state, so that it's hopefully ready by the time the
+         * shader is first used. */
+        case WINED3D_SHADER_TYPE_VERTEX:
+            if (!wined3d_settings.async_shader_compile)
+                break;
+            context = context_acquire(device, NULL, 0);
+            context_gl = wined3d_context_gl(context);
+            find_vs_compile_args(state, shader, &vs_args, context);
+            find_glsl_vertex_shader(context_gl, priv, shader, &vs_args);
+            context_release(context);
+            break;
+
+        case WINED3D_SHADER_TYPE_PIXEL:
+            if (!wined3d_settings.async_shader_compile)
+                break;
+            context = context_acquire(device, NULL, 0);
+            context_gl = wined3d_context_gl(context);
+            find_ps_compile_args(state, shader, context->stream_info.position_transformed, &ps_args, context);
+            find_glsl_fragment_shader(context_gl, &priv->shader_buffer, &priv->string_buffers,
+                    shader, &ps_args, &np2fixup_info);
+            context_release(context);
+            break;
+
+        default:
+            break;
     }
 }
 
@@ -10674,7 +11019,7 @@ static void shader_glsl_select(void *shader_priv, struct wined3d_context *contex
     priv->fragment_pipe->fp_enable(context, !use_ps(state));
 
     prev_id = ctx_data->glsl_program ? ctx_data->glsl_program->id : 0;
-    set_glsl_shader_program(context_gl, state, priv, ctx_data);
+    context->shader_program_pending = !set_glsl_shader_program(context_gl, state, priv, ctx_data);
     glsl_program = ctx_data->glsl_program;
 
     if (glsl_program)
@@ -11111,6 +11456,10 @@ static void shader_glsl_free(struct wined3d_device *device, struct wined3d_conte
 {
     struct shader_glsl_priv *priv = device->shader_priv;
 
+    if (wined3d_settings.shader_cache_path)
+        WARN_(d3d_perf)("Shader cache statistics: %d hits, %d misses.\n",
+                glsl_program_cache_hits, glsl_program_cache_misses);
+
     wine_rb_destroy(&priv->program_lookup, NULL, NULL);
     constant_heap_free(&priv->pconst_heap);
     constant_heap_free(&priv->vconst_heap);
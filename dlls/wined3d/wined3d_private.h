@@ -484,9 +484,11 @@ struct wined3d_settings
     /* Memory tracking and object counting. */
     UINT64 emulated_textureram;
     char *logo;
+    char *shader_cache_path;
     unsigned int multisample_textures;
     unsigned int sample_count;
     BOOL check_float_constants;
+    BOOL async_shader_compile;
     unsigned int strict_shader_math;
     unsigned int max_sm_vs;
     unsigned int max_sm_hs;
@@ -2149,6 +2151,8 @@ struct wined3d_context
     const struct wined3d_d3d_info *d3d_info;
     const struct wined3d_state_entry *state_table;
     uint32_t dirty_graphics_states[WINED3D_BITMAP_SIZE(STATE_HIGHEST)];
+    /* One bit for each non-zero word in dirty_graphics_states. */
+    uint32_t dirty_graphics_words[WINED3D_BITMAP_SIZE(WINED3D_BITMAP_SIZE(STATE_HIGHEST))];
     uint32_t dirty_compute_states[WINED3D_BITMAP_SIZE(STATE_COMPUTE_COUNT)];
 
     struct wined3d_device *device;
@@ -2194,7 +2198,8 @@ struct wined3d_context
     DWORD destroy_delayed : 1;
     DWORD clip_distance_mask : 8; /* WINED3D_MAX_CLIP_DISTANCES, 8 */
     DWORD namedArraysLoaded : 1;
-    DWORD padding : 13;
+    DWORD shader_program_pending : 1;
+    DWORD padding : 12;
 
     DWORD constant_update_mask;
     DWORD numbered_array_mask;
@@ -6576,6 +6581,19 @@ static inline BOOL wined3d_bitmap_get_range(const DWORD *bitmap, unsigned int bi
     return TRUE;
 }
 
+static inline void wined3d_context_set_graphics_state_dirty(struct wined3d_context *context,
+        unsigned int representative)
+{
+    wined3d_bitmap_set(context->dirty_graphics_states, representative);
+    wined3d_bitmap_set(context->dirty_graphics_words, representative >> 5);
+}
+
+static inline void wined3d_context_clear_graphics_states_dirty(struct wined3d_context *context)
+{
+    memset(context->dirty_graphics_states, 0, sizeof(context->dirty_graphics_states));
+    memset(context->dirty_graphics_words, 0, sizeof(context->dirty_graphics_words));
+}
+
 static inline bool wined3d_context_is_graphics_state_dirty(const struct wined3d_context *context, unsigned int state_id)
 {
     return wined3d_bitmap_is_set(context->dirty_graphics_states, state_id);
@@ -190,6 +190,7 @@ static void CDECL macdrv_surface_flush(struct window_surface *window_surface)
     }
     update_blit_data(surface);
     reset_bounds(&surface->bounds);
+    surface->header.damage.count = 0;
 
     window_surface->funcs->unlock(window_surface);
 
@@ -510,6 +510,7 @@ static void sync_window_opacity(struct macdrv_win_data *data, COLORREF key, BYTE
         data->surface->funcs->lock(data->surface);
         bounds = data->surface->funcs->get_bounds(data->surface);
         add_bounds_rect(bounds, &rect);
+        window_surface_add_damage(data->surface, &rect);
         data->surface->funcs->unlock(data->surface);
     }
 }
@@ -1959,6 +1960,7 @@ BOOL CDECL macdrv_UpdateLayeredWindow(HWND hwnd, const UPDATELAYEREDWINDOWINFO *
             surface->funcs->lock(surface);
             memcpy(dst_bits, src_bits, bmi->bmiHeader.biSizeImage);
             add_bounds_rect(surface->funcs->get_bounds(surface), &rect);
+            window_surface_add_damage(surface, &rect);
             surface->funcs->unlock(surface);
             surface->funcs->flush(surface);
         }
@@ -1886,70 +1886,97 @@ static void CDECL x11drv_surface_set_region( struct window_surface *window_surfa
     window_surface->funcs->unlock( window_surface );
 }
 
+/***********************************************************************
+ *           flush_surface_rect
+ */
+static void flush_surface_rect( struct x11drv_window_surface *surface, const RECT *rect )
+{
+    unsigned char *src = surface->bits;
+    unsigned char *dst = (unsigned char *)surface->image->data;
+
+    if (src != dst)
+    {
+        int map[256], *mapping = get_window_surface_mapping( surface->image->bits_per_pixel, map );
+        int width_bytes = surface->image->bytes_per_line;
+
+        src += rect->top * width_bytes;
+        dst += rect->top * width_bytes;
+        if (!surface->byteswap && !mapping)
+        {
+            /* only copy the columns covered by the rectangle */
+            int bpp = surface->image->bits_per_pixel, y;
+            int start = rect->left * bpp / 8, len = (rect->right * bpp + 7) / 8 - start;
+
+            for (y = rect->top; y < rect->bottom; y++, src += width_bytes, dst += width_bytes)
+                memcpy( dst + start, src + start, len );
+        }
+        else copy_image_byteswap( &surface->info, src, dst, width_bytes, width_bytes,
+                                  rect->bottom - rect->top,
+                                  surface->byteswap, mapping, ~0u, surface->alpha_bits );
+    }
+    else if (surface->alpha_bits)
+    {
+        int x, y, stride = surface->image->bytes_per_line / sizeof(ULONG);
+        ULONG *ptr = (ULONG *)dst + rect->top * stride;
+
+        for (y = rect->top; y < rect->bottom; y++, ptr += stride)
+            for (x = rect->left; x < rect->right; x++)
+                ptr[x] |= surface->alpha_bits;
+    }
+
+#ifdef HAVE_LIBXXSHM
+    if (surface->shminfo.shmid != -1)
+        XShmPutImage( gdi_display, surface->window, surface->gc, surface->image,
+                      rect->left, rect->top,
+                      surface->header.rect.left + rect->left,
+                      surface->header.rect.top + rect->top,
+                      rect->right - rect->left, rect->bottom - rect->top, False );
+    else
+#endif
+    XPutImage( gdi_display, surface->window, surface->gc, surface->image,
+               rect->left, rect->top,
+               surface->header.rect.left + rect->left,
+               surface->header.rect.top + rect->top,
+               rect->right - rect->left, rect->bottom - rect->top );
+}
+
 /***********************************************************************
  *           x11drv_surface_flush
  */
 static void CDECL x11drv_surface_flush( struct window_surface *window_surface )
 {
     struct x11drv_window_surface *surface = get_x11_surface( window_surface );
-    unsigned char *src = surface->bits;
-    unsigned char *dst = (unsigned char *)surface->image->data;
-    struct bitblt_coords coords;
+    const struct window_surface_damage *damage = &window_surface->damage;
+    const RECT *rects = damage->rects;
+    UINT i, count = damage->count;
+    RECT visrect, damage_bounds, rect;
 
     window_surface->funcs->lock( window_surface );
-    coords.x = 0;
-    coords.y = 0;
-    coords.width  = surface->header.rect.right - surface->header.rect.left;
-    coords.height = surface->header.rect.bottom - surface->header.rect.top;
-    SetRect( &coords.visrect, 0, 0, coords.width, coords.height );
-    if (IntersectRect( &coords.visrect, &coords.visrect, &surface->bounds ))
+    SetRect( &visrect, 0, 0, surface->header.rect.right - surface->header.rect.left,
+             surface->header.rect.bottom - surface->header.rect.top );
+    if (IntersectRect( &visrect, &visrect, &surface->bounds ))
     {
-        TRACE( "flushing %p %dx%d bounds %s bits %p\n",
-               surface, coords.width, coords.height,
-               wine_dbgstr_rect( &surface->bounds ), surface->bits );
+        TRACE( "flushing %p %dx%d bounds %s damage %u bits %p\n",
+               surface, visrect.right, visrect.bottom,
+               wine_dbgstr_rect( &surface->bounds ), count, surface->bits );
 
         if (surface->is_argb || surface->color_key != CLR_INVALID) update_surface_region( surface );
 
-        if (src != dst)
+        /* only flush the damaged areas if they account for everything drawn since the last flush */
+        reset_bounds( &damage_bounds );
+        for (i = 0; i < count; i++) add_bounds_rect( &damage_bounds, &rects[i] );
+        if (!count || !EqualRect( &damage_bounds, &surface->bounds ))
         {
-            int map[256], *mapping = get_window_surface_mapping( surface->image->bits_per_pixel, map );
-            int width_bytes = surface->image->bytes_per_line;
-
-            src += coords.visrect.top * width_bytes;
-            dst += coords.visrect.top * width_bytes;
-            copy_image_byteswap( &surface->info, src, dst, width_bytes, width_bytes,
-                                 coords.visrect.bottom - coords.visrect.top,
-                                 surface->byteswap, mapping, ~0u, surface->alpha_bits );
+            rects = &surface->bounds;
+            count = 1;
         }
-        else if (surface->alpha_bits)
-        {
-            int x, y, stride = surface->image->bytes_per_line / sizeof(ULONG);
-            ULONG *ptr = (ULONG *)dst + coords.visrect.top * stride;
 
-            for (y = coords.visrect.top; y < coords.visrect.bottom; y++, ptr += stride)
-                for (x = coords.visrect.left; x < coords.visrect.right; x++)
-                    ptr[x] |= surface->alpha_bits;
-        }
-
-#ifdef HAVE_LIBXXSHM
-        if (surface->shminfo.shmid != -1)
-            XShmPutImage( gdi_display, surface->window, surface->gc, surface->image,
-                          coords.visrect.left, coords.visrect.top,
-                          surface->header.rect.left + coords.visrect.left,
-                          surface->header.rect.top + coords.visrect.top,
-                          coords.visrect.right - coords.visrect.left,
-                          coords.visrect.bottom - coords.visrect.top, False );
-        else
-#endif
-        XPutImage( gdi_display, surface->window, surface->gc, surface->image,
-                   coords.visrect.left, coords.visrect.top,
-                   surface->header.rect.left + coords.visrect.left,
-                   surface->header.rect.top + coords.visrect.top,
-                   coords.visrect.right - coords.visrect.left,
-                   coords.visrect.bottom - coords.visrect.top );
+        for (i = 0; i < count; i++)
+            if (IntersectRect( &rect, &visrect, &rects[i] )) flush_surface_rect( surface, &rect );
         XFlush( gdi_display );
     }
     reset_bounds( &surface->bounds );
+    window_surface->damage.count = 0;
     window_surface->funcs->unlock( window_surface );
 }
 
@@ -2097,6 +2124,7 @@ HRGN expose_surface( struct window_surface *window_surface, const RECT *rect )
     window_surface->funcs->lock( window_surface );
     OffsetRect( &rc, -window_surface->rect.left, -window_surface->rect.top );
     add_bounds_rect( &surface->bounds, &rc );
+    window_surface_add_damage( window_surface, &rc );
     if (surface->region)
     {
         region = CreateRectRgnIndirect( rect );
@@ -2783,6 +2783,7 @@ BOOL CDECL X11DRV_UpdateLayeredWindow( HWND hwnd, const UPDATELAYEREDWINDOWINFO
     {
         memcpy( dst_bits, src_bits, bmi->bmiHeader.biSizeImage );
         add_bounds_rect( surface->funcs->get_bounds( surface ), &rect );
+        window_surface_add_damage( surface, &rect );
     }
 
     surface->funcs->unlock( surface );
@@ -166,7 +166,7 @@ struct gdi_dc_funcs
 };
 
 /* increment this when you change the DC function table */
-#define WINE_GDI_DRIVER_VERSION 74
+#define WINE_GDI_DRIVER_VERSION 75
 
 #define GDI_PRIORITY_NULL_DRV        0  /* null driver */
 #define GDI_PRIORITY_FONT_DRV      100  /* any font driver */
@@ -196,6 +196,16 @@ static inline void push_dc_driver( PHYSDEV *dev, PHYSDEV physdev, const struct g
 
 struct window_surface;
 
+#define WINDOW_SURFACE_MAX_DAMAGE 8
+
+/* areas drawn to since the last flush, their union is contained in the surface bounds;
+ * the driver resets them along with the bounds when flushing */
+struct window_surface_damage
+{
+    UINT  count;
+    RECT  rects[WINDOW_SURFACE_MAX_DAMAGE];
+};
+
 struct window_surface_funcs
 {
     void  (CDECL *lock)( struct window_surface *surface );
@@ -213,6 +223,7 @@ struct window_surface
     struct list                        entry; /* entry in global list managed by user32 */
     LONG                               ref;   /* reference count */
     RECT                               rect;  /* constant, no locking needed */
+    struct window_surface_damage       damage; /* areas drawn to, protected by the surface lock */
     /* driver-specific fields here */
 };
 
@@ -228,6 +239,45 @@ static inline ULONG window_surface_release( struct window_surface *surface )
     return ret;
 }
 
+static inline LONG window_surface_rect_area( const RECT *rect )
+{
+    return (rect->right - rect->left) * (rect->bottom - rect->top);
+}
+
+static inline void window_surface_add_damage( struct window_surface *surface, const RECT *rect )
+{
+    struct window_surface_damage *damage = &surface->damage;
+    UINT i, best = 0;
+    LONG growth, best_growth = 0;
+    RECT merged;
+
+    if (rect->left >= rect->right || rect->top >= rect->bottom) return;
+
+    /* find the rectangle that can absorb the new one with the least extra area */
+    for (i = 0; i < damage->count; i++)
+    {
+        merged.left   = min( damage->rects[i].left, rect->left );
+        merged.top    = min( damage->rects[i].top, rect->top );
+        merged.right  = max( damage->rects[i].right, rect->right );
+        merged.bottom = max( damage->rects[i].bottom, rect->bottom );
+        growth = window_surface_rect_area( &merged ) - window_surface_rect_area( &damage->rects[i] )
+                 - window_surface_rect_area( rect );
+        if (i && growth >= best_growth) continue;
+        best = i;
+        best_growth = growth;
+    }
+
+    if (damage->count < WINDOW_SURFACE_MAX_DAMAGE && (!damage->count || best_growth > 0))
+    {
+        damage->rects[damage->count++] = *rect;
+        return;
+    }
+    damage->rects[best].left   = min( damage->rects[best].left, rect->left );
+    damage->rects[best].top    = min( damage->rects[best].top, rect->top );
+    damage->rects[best].right  = max( damage->rects[best].right, rect->right );
+    damage->rects[best].bottom = max( damage->rects[best].bottom, rect->bottom );
+}
+
 /* display manager interface, used to initialize display device registry data */
 
 struct gdi_gpu